@@ -16,6 +16,9 @@
 #include <GR/GR_Primitive.h>
 
 #include "GEO_GSplat.h"
+#include "GSplatSorter.h"
+#include "GSplatStore.h"
+#include "GSplatRegistry.h"
 
 /// The primitive render hook which creates GR_PrimGsplat objects.
 class GR_PrimGsplatHook : public GUI_PrimitiveHook
@@ -49,7 +52,8 @@ public:
 class GR_PrimGsplat : public GR_Primitive
 {
 private:
-	std::string myRegistryId;
+	std::string myRegistryId; // key of myStore
+	GSplatRegistry::Handle myRegistryHandle = GSplatRegistry::INVALID_HANDLE;
 
 public:
 	GR_PrimGsplat(const GR_RenderInfo *info,
@@ -112,24 +116,70 @@ private:
 	bool initSHHandleRestAttrs(const GU_Detail *gdp, SHHandles& handles, const char* name, int index);
 	bool initAllSHHandles(const GU_Detail *gdp, SHHandles& handles, const char *detail_id);
 
+	// The optional attributes the gather reads, null when missing
+	struct GatherAttributes {
+		const GA_Attribute *color = nullptr;
+		const GA_Attribute *alpha = nullptr;
+		const GA_Attribute *scale = nullptr;
+		const GA_Attribute *orient = nullptr;
+		// Written by the GSplat Source SOP along with the LOD hierarchy, see GSplatLodBuilder
+		const GA_Attribute *lodExtent = nullptr;
+		const GA_Attribute *lodParentExtent = nullptr;
+	};
+
+	// Consecutive point offsets within one GA page, landing in consecutive splats
+	struct GatherRun {
+		GA_Offset start;
+		GA_Size count;
+		GA_Size splatIndex;
+	};
+
+	static void buildGatherRuns(const GEO_PrimGsplat *prim, std::vector<GatherRun> &runs);
+
+	// Reads the attributes into store a page run at a time. Specialised for the SH layout, and
+	// attribute presence is settled per run, so nothing is decided nor allocated per point.
+	// Only the GSplatStore::Attribute in attributeMask are read.
+	template <SHHandles::SHAttributeType SH_TYPE>
+	static void gatherSplats(
+		const GU_Detail *gdp,
+		const GatherAttributes &attributes,
+		const SHHandles &shHandles,
+		const std::vector<GatherRun> &runs,
+		const unsigned attributeMask,
+		GSplatStore &store);
+
+	// Data ids of everything the store is gathered from, see GSplatStore::findChangedAttributes
+	static void collectSourceIds(
+		const GU_Detail *gdp,
+		const GEO_PrimGsplat *prim,
+		const GatherAttributes &attributes,
+		const SHHandles &shHandles,
+		GSplatStore::SourceIds sourceIds[GSplatStore::SOURCE_COUNT]);
+
 	int	myID;
 
 	std::string myGsplatStrId;
 	RE_Geometry *myWireframeGeo;
+	// The store key and version the wire attributes were last filled from
+	std::string myWireRegistryId;
+	RE_CacheVersion myWireGeoVersion;
 	GA_Size myGsplatCount;
-	UT_Vector3Array mySplatPts;
-	UT_Vector3HArray mySplatColors;
-	UT_FloatArray mySplatAlphas; //TODO: make 16 bit like the rest?
-	UT_Vector3HArray mySplatScales;
-	UT_Vector4HArray mySplatOrients;
-	MyUT_Matrix4HArray myShxs;
-	MyUT_Matrix4HArray myShys;
-	MyUT_Matrix4HArray myShzs;
+	// Shared with the renderer registry, and with any other primitive drawing the same version
+	GSplatStore::Handle myStore;
 
 	bool mySetExplicitCameraPos;
 	UT_Vector3 myExplicitCameraPos;
 
 	int myShOrder;
+	GSplatSorter::SortMode mySortMode;
+	float myCullMinOpacity;
+	float myCullMinPixelRadius;
+	float myLodPixelError;
+	bool myCompactEncoding;
+	int myShCodebookSize;
+	bool myShBake;
+	bool myQuadVertices;
+	int myGpuMemoryBudget;
 };
 
 
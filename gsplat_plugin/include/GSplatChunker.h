@@ -0,0 +1,112 @@
+/***************************************************************************************/
+/*  Filename: GSplatChunker.h                                                          */
+/*  Description: Spatial chunking and hierarchical depth sorting for the GSplat Plugin */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_CHUNKER__
+#define __GSPLAT_CHUNKER__
+
+#include "GSplatCuller.h"
+#include "GSplatSorter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Splats are laid out along a Morton curve at pack time so that every CHUNK_SIZE consecutive
+// splats form a compact spatial chunk. Per frame, chunks are culled and ordered as a whole and
+// only chunks whose depth ranges overlap are sorted together at splat level.
+class GSplatChunker
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    struct Chunk {
+        float center[3];
+        float radius;       // bounding sphere of the 3 sigma spheres of its splats, for culling
+        float pointRadius;  // bounding sphere of the splat centres, for depth ranges
+        float maxAlpha;
+        int begin;
+        int count;
+    };
+
+    // Writes into outDestinations, for every point, its index along a Morton curve through
+    // the bounding box of the points. Packing splat i at outDestinations[i] makes chunks compact.
+    static void computeSpatialOrder(const float *positions, const size_t count, int *outDestinations);
+
+    // Builds the chunks over splats already laid out in spatial order.
+    void buildChunks(const float *positions, const float *radii, const float *alphas, const size_t count);
+
+    // Rebuilds the chunks overlapping splats [begin, end) after they changed in place.
+    void updateChunks(const float *positions, const float *radii, const float *alphas, const size_t begin, const size_t end);
+
+    void clear() { myChunks.clear(); myChunkedCount = 0; }
+
+    const std::vector<Chunk>& getChunks() const { return myChunks; }
+
+    // Working memory of sortVisible, reused from one sort to the next. Sorts running
+    // concurrently, for different views, each need their own.
+    struct SortScratch;
+
+    // Writes into outIndices the visible splats ordered front to back as seen from cameraPos,
+    // returns how many there are, or -1 if cancelled. outIndices must have room for count entries.
+    // lodExtents is optional, as for GSplatCuller::cull. Only reads the chunks.
+    int sortVisible(
+        const float *positions,
+        const float *radii,
+        const float *alphas,
+        const float *lodExtents,
+        const size_t count,
+        const GSplatCuller::Frustum &frustum,
+        const float *cameraPos,
+        int *outIndices,
+        SortScratch &scratch,
+        const std::atomic<bool> *cancelRequested = nullptr) const;
+
+private:
+    // Groups above this many splats go through the (parallel) radix sorter one after the other,
+    // smaller ones are sorted in parallel with each other.
+    static constexpr size_t LARGE_GROUP_SIZE = 1 << 16;
+
+    struct VisibleChunk {
+        float nearDistance;
+        float farDistance;
+        int chunk;
+        int visibleCount; // splats that passed culling, stored from myCandidates[chunk.begin]
+        int outputOffset;
+    };
+
+    struct Group {
+        int firstVisibleChunk;
+        int lastVisibleChunk; // inclusive
+        int outputOffset;
+        int splatCount;
+    };
+
+    bool isCancelRequested(const std::atomic<bool> *cancelRequested) const { return cancelRequested && cancelRequested->load(std::memory_order_relaxed); }
+
+    std::vector<Chunk> myChunks;
+    size_t myChunkedCount = 0;
+
+public:
+    struct SortScratch {
+        std::vector<VisibleChunk> visibleChunks;
+        std::vector<Group> groups;
+        std::vector<int> candidates;
+        std::vector<uint64_t> keyIndexPairs;
+        std::vector<int> groupSplats;
+        std::vector<float> groupPositions;
+        std::vector<int> groupOrder;
+        GSplatSorter groupSorter;
+    };
+};
+
+
+#endif // __GSPLAT_CHUNKER__
@@ -0,0 +1,243 @@
+/***************************************************************************************/
+/*  Filename: GSplatCoreMath.h                                                         */
+/*  Description: HDK independent port of the shader core lib maths                     */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_CORE_MATH__
+#define __GSPLAT_CORE_MATH__
+
+#include <algorithm>
+#include <cmath>
+
+
+// The functions of GSplatCoreLib and GSplatSphericalHarmonicsLib (GSplatShaderCoreLib.h),
+// written out in C++ term for term so that whatever draws splats on the CPU draws them as
+// the shaders do. Matrices follow the GLSL conventions: column-major, m[column][row], and a
+// mat4 given as 16 floats reads the data of a row-major row-vector matrix (the UT_Matrix4
+// layout the viewport binds) as the column-major matrix the shaders see.
+//
+// Keep in step with the GLSL: a change to one is a change to both.
+
+struct GSplatVec2
+{
+    float x, y;
+};
+
+struct GSplatVec3
+{
+    float x, y, z;
+};
+
+struct GSplatMat3
+{
+    float m[3][3]; // m[column][row]
+
+    GSplatMat3 operator*(const GSplatMat3 &b) const
+    {
+        GSplatMat3 result;
+        for (int c = 0; c < 3; ++c)
+        {
+            for (int r = 0; r < 3; ++r)
+            {
+                result.m[c][r] = m[0][r] * b.m[c][0] + m[1][r] * b.m[c][1] + m[2][r] * b.m[c][2];
+            }
+        }
+        return result;
+    }
+
+    GSplatVec3 operator*(const GSplatVec3 &v) const
+    {
+        return {
+            m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+            m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+            m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z };
+    }
+
+    GSplatMat3 transposed() const
+    {
+        GSplatMat3 result;
+        for (int c = 0; c < 3; ++c)
+        {
+            for (int r = 0; r < 3; ++r)
+            {
+                result.m[c][r] = m[r][c];
+            }
+        }
+        return result;
+    }
+
+    // Upper left 3x3 of a mat4, mat3(matrix) in GLSL
+    static GSplatMat3 fromMat4(const float matrix[16])
+    {
+        GSplatMat3 result;
+        for (int c = 0; c < 3; ++c)
+        {
+            for (int r = 0; r < 3; ++r)
+            {
+                result.m[c][r] = matrix[c * 4 + r];
+            }
+        }
+        return result;
+    }
+};
+
+// (matrix * vec4(p, 1)).xyz
+inline GSplatVec3 gsplatTransformPoint(const float matrix[16], const GSplatVec3 &p)
+{
+    return {
+        matrix[0] * p.x + matrix[4] * p.y + matrix[8] * p.z + matrix[12],
+        matrix[1] * p.x + matrix[5] * p.y + matrix[9] * p.z + matrix[13],
+        matrix[2] * p.x + matrix[6] * p.y + matrix[10] * p.z + matrix[14] };
+}
+
+// rot is wxyz, the packed xyzw orient swizzled as the vertex shader does
+inline GSplatMat3 gsplatCalcMatrixFromRotationScale(const float rot[4], const GSplatVec3 &scale)
+{
+    const GSplatMat3 ms = {{
+        { scale.x, 0, 0 },
+        { 0, scale.y, 0 },
+        { 0, 0, scale.z } }};
+    const float x = rot[0];
+    const float y = rot[1];
+    const float z = rot[2];
+    const float w = rot[3];
+    const GSplatMat3 mr = {{
+        { 1.0f - 2.0f * (z * z + w * w), 2.0f * (y * z - x * w), 2.0f * (y * w + x * z) },
+        { 2.0f * (y * z + x * w), 1.0f - 2.0f * (y * y + w * w), 2.0f * (z * w - x * y) },
+        { 2.0f * (y * w - x * z), 2.0f * (z * w + x * y), 1.0f - 2.0f * (y * y + z * z) } }};
+    return ms * mr;
+}
+
+// The sigma matrix of CalcCovariance3D, the vec3 halves of it are its upper triangle
+inline GSplatMat3 gsplatCalcCovariance3D(const GSplatMat3 &rotMat)
+{
+    return rotMat.transposed() * rotMat;
+}
+
+// from "EWA Splatting" (Zwicker et al 2002) eq. 31, returns cov[0][0], cov[0][1] and cov[1][1]
+inline GSplatVec3 gsplatCalcCovariance2D(
+    const GSplatVec3 &worldPos,
+    const float matrixV[16],
+    const float matrixP[16],
+    const float screenWidth,
+    const GSplatMat3 &sigma)
+{
+    GSplatVec3 viewPos = gsplatTransformPoint(matrixV, worldPos);
+
+    const float aspect = matrixP[0] / matrixP[5];
+    const float tanFovX = 1.0f / matrixP[0];
+    const float tanFovY = 1.0f / (matrixP[5] * aspect);
+
+    const float limX = 1.3f * tanFovX;
+    const float limY = 1.3f * tanFovY;
+    viewPos.x = std::min(std::max(viewPos.x / viewPos.z, -limX), limX) * viewPos.z;
+    viewPos.y = std::min(std::max(viewPos.y / viewPos.z, -limY), limY) * viewPos.z;
+
+    const float focal = screenWidth * matrixP[0] / 2;
+
+    const GSplatMat3 J = {{
+        { focal / viewPos.z, 0, -(focal * viewPos.x) / (viewPos.z * viewPos.z) },
+        { 0, focal / viewPos.z, -(focal * viewPos.y) / (viewPos.z * viewPos.z) },
+        { 0, 0, 0 } }};
+    const GSplatMat3 W = GSplatMat3::fromMat4(matrixV).transposed();
+    const GSplatMat3 T = W * J;
+
+    GSplatMat3 cov = T.transposed() * (sigma.transposed() * T);
+
+    // Low pass filter to make each splat at least 1px size.
+    cov.m[0][0] += 0.3f;
+    cov.m[1][1] += 0.3f;
+    return { cov.m[0][0], cov.m[0][1], cov.m[1][1] };
+}
+
+// From antimatter15/splat
+inline void gsplatDecomposeCovariance(const GSplatVec3 &cov2d, GSplatVec2 &v1, GSplatVec2 &v2)
+{
+    const float diag1 = cov2d.x;
+    const float diag2 = cov2d.z;
+    const float offDiag = cov2d.y;
+    const float mid = 0.5f * (diag1 + diag2);
+    const float radius = std::sqrt((diag1 - diag2) / 2.0f * ((diag1 - diag2) / 2.0f) + offDiag * offDiag);
+    const float lambda1 = mid + radius;
+    const float lambda2 = std::max(mid - radius, 0.1f);
+    // Both are the eigenvector of lambda1, the one without a cancellation is used: lambda1 - diag1
+    // is rounding noise when the off diagonal is about zero and diag1 the larger. Zero length
+    // only when isotropic, any direction will do then.
+    const GSplatVec2 eigenVec = diag1 >= diag2 ? GSplatVec2{ lambda1 - diag2, offDiag } : GSplatVec2{ offDiag, lambda1 - diag1 };
+    const float diagLength = std::sqrt(eigenVec.x * eigenVec.x + eigenVec.y * eigenVec.y);
+    GSplatVec2 diagVec = diagLength > 0.0f ? GSplatVec2{ eigenVec.x / diagLength, eigenVec.y / diagLength } : GSplatVec2{ 1.0f, 0.0f };
+    diagVec.y = -diagVec.y;
+    const float maxSize = 4096.0f;
+    const float length1 = std::min(std::sqrt(2.0f * lambda1), maxSize);
+    const float length2 = std::min(std::sqrt(2.0f * lambda2), maxSize);
+    v1 = { length1 * diagVec.x, length1 * diagVec.y };
+    v2 = { length2 * diagVec.y, -length2 * diagVec.x };
+}
+
+// ShadeSH for one colour channel. sh holds the 15 coefficients of degrees 1 to 3 of the
+// channel, only the ones of the degrees up to shOrder are read.
+inline float gsplatShadeSH(const float color, const float *sh, const GSplatVec3 &dir, const int shOrder)
+{
+    const float SH_C1 = 0.4886025f;
+    const float SH_C2_0 = 1.0925484f;
+    const float SH_C2_1 = -1.0925484f;
+    const float SH_C2_2 = 0.3153916f;
+    const float SH_C2_3 = -1.0925484f;
+    const float SH_C2_4 = 0.5462742f;
+    const float SH_C3_0 = -0.5900436f;
+    const float SH_C3_1 = 2.8906114f;
+    const float SH_C3_2 = -0.4570458f;
+    const float SH_C3_3 = 0.3731763f;
+    const float SH_C3_4 = -0.4570458f;
+    const float SH_C3_5 = 1.4453057f;
+    const float SH_C3_6 = -0.5900436f;
+
+    const float x = dir.x;
+    const float y = dir.y;
+    const float z = dir.z;
+
+    // ambient band, col = sh0 * SH_C0 + 0.5 is already precomputed
+    float res = color;
+    // 1st degree
+    if (shOrder >= 1)
+    {
+        res += SH_C1 * (-sh[0] * y + sh[1] * z - sh[2] * x);
+        // 2nd degree
+        if (shOrder >= 2)
+        {
+            const float xx = x * x;
+            const float yy = y * y;
+            const float zz = z * z;
+            const float xy = x * y;
+            const float yz = y * z;
+            const float xz = x * z;
+            res +=
+                (SH_C2_0 * xy) * sh[3] +
+                (SH_C2_1 * yz) * sh[4] +
+                (SH_C2_2 * (2 * zz - xx - yy)) * sh[5] +
+                (SH_C2_3 * xz) * sh[6] +
+                (SH_C2_4 * (xx - yy)) * sh[7];
+            // 3rd degree
+            if (shOrder >= 3)
+            {
+                res +=
+                    (SH_C3_0 * y * (3 * xx - yy)) * sh[8] +
+                    (SH_C3_1 * xy * z) * sh[9] +
+                    (SH_C3_2 * y * (4 * zz - xx - yy)) * sh[10] +
+                    (SH_C3_3 * z * (2 * zz - 3 * xx - 3 * yy)) * sh[11] +
+                    (SH_C3_4 * x * (4 * zz - xx - yy)) * sh[12] +
+                    (SH_C3_5 * z * (xx - yy)) * sh[13] +
+                    (SH_C3_6 * x * (xx - 3 * yy)) * sh[14];
+            }
+        }
+    }
+    return std::max(res, 0.0f);
+}
+
+
+#endif // __GSPLAT_CORE_MATH__
@@ -0,0 +1,126 @@
+/***************************************************************************************/
+/*  Filename: GSplatCuller.h                                                           */
+/*  Description: CPU visibility culling for the GSplat Plugin                          */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_CULLER__
+#define __GSPLAT_CULLER__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+class GSplatCuller
+{
+public:
+    // Splats smaller than 3 sigma radius (in pixels) or more transparent than these are dropped.
+    // The default opacity matches the fragment shader discard, so it never changes the image.
+    static constexpr float DEFAULT_MIN_OPACITY = 1.0f / 255.0f;
+    static constexpr float DEFAULT_MIN_PIXEL_RADIUS = 0.0f;
+    // Largest projected extent (in pixels) of a LOD node drawn in place of its subtree
+    static constexpr float DEFAULT_LOD_PIXEL_ERROR = 1.0f;
+
+    // Frustum planes and thresholds prepared once per frame.
+    struct Frustum {
+        float planes[6][4]; // normalised, distances in world units
+        float wRow[4];      // clip w as a function of the world position
+        float wRowLength;   // length of the xyz part of wRow, how fast w changes with distance
+        float pixelScale;
+        float minOpacity;
+        float minPixelRadius;
+        float lodPixelError;
+    };
+
+    // World space radius enclosing 3 sigma of a gaussian with the given (linear) axis scales.
+    static float computeCullRadius(const float scaleX, const float scaleY, const float scaleZ);
+
+    // viewProj is the world to clip space transform, row-major for row vectors (p * M) as
+    // returned by RE_Render::getMatrix. pixelScale converts a view space radius at unit depth
+    // to pixels (projection y scale times half the viewport height).
+    static Frustum makeFrustum(
+        const double viewProj[16], 
+        const float pixelScale, 
+        const float minOpacity, 
+        const float minPixelRadius, 
+        const float lodPixelError);
+
+    // Whether a splat passes the frustum, opacity and projected size tests.
+    static inline bool isVisible(const Frustum &frustum, const float *center, const float radius, const float alpha)
+    {
+        // The vertex shader drops splats whose centre is behind the camera
+        const float w = center[0] * frustum.wRow[0] + center[1] * frustum.wRow[1] + center[2] * frustum.wRow[2] + frustum.wRow[3];
+        bool visible = w > 0.0f && alpha >= frustum.minOpacity && radius * frustum.pixelScale >= frustum.minPixelRadius * w;
+        for (int p = 0; visible && p < 6; ++p)
+        {
+            const float *plane = frustum.planes[p];
+            visible = center[0] * plane[0] + center[1] * plane[1] + center[2] * plane[2] + plane[3] >= -radius;
+        }
+        return visible;
+    }
+
+    // Whether a node of a LOD hierarchy is part of the cut drawn: its subtree projects within
+    // the error target but the one of its parent does not. lodExtents holds the extent and
+    // parent extent of the node, see GSplatLodBuilder. Both are measured at the centre of the
+    // node, close enough to its parent for the cut to hardly ever overlap or leave holes.
+    static inline bool isInLodCut(const Frustum &frustum, const float *center, const float *lodExtents)
+    {
+        const float w = center[0] * frustum.wRow[0] + center[1] * frustum.wRow[1] + center[2] * frustum.wRow[2] + frustum.wRow[3];
+        const float error = frustum.lodPixelError * w;
+        return lodExtents[0] * frustum.pixelScale <= error && lodExtents[1] * frustum.pixelScale > error;
+    }
+
+    // Conservative version of isVisible for a group of splats, given their bounding sphere and
+    // largest opacity: false only if none of the splats inside can be visible.
+    static inline bool isGroupVisible(const Frustum &frustum, const float *center, const float radius, const float maxAlpha)
+    {
+        if (maxAlpha < frustum.minOpacity)
+        {
+            return false;
+        }
+        for (int p = 0; p < 6; ++p)
+        {
+            const float *plane = frustum.planes[p];
+            if (center[0] * plane[0] + center[1] * plane[1] + center[2] * plane[2] + plane[3] < -radius)
+            {
+                return false;
+            }
+        }
+        // No splat is larger than the group, nor closer than its nearest point
+        const float w = center[0] * frustum.wRow[0] + center[1] * frustum.wRow[1] + center[2] * frustum.wRow[2] + frustum.wRow[3];
+        const float nearestW = w - radius * frustum.wRowLength;
+        return nearestW <= 0.0f || radius * frustum.pixelScale >= frustum.minPixelRadius * nearestW;
+    }
+
+    // Writes into outVisible, in ascending order, the indices of the splats whose bounding
+    // sphere intersects the view frustum and that pass the opacity and projected size tests.
+    // positions holds count xyz triplets, radii and alphas count values. When given, lodExtents
+    // holds count pairs and only the splats in the LOD cut are kept, see isInLodCut.
+    // outVisible must have room for count entries. Returns the number of visible splats.
+    size_t cull(
+        const float *positions,
+        const float *radii,
+        const float *alphas,
+        const float *lodExtents,
+        const size_t count,
+        const Frustum &frustum,
+        int *outVisible);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 14;
+
+    // Sides of the frustum are pushed out by this factor of w, so that splats entering the
+    // view while a background sort is in flight are already part of the displayed order.
+    static constexpr float GUARD_BAND = 1.15f;
+
+    std::vector<uint8_t> myVisibility;
+    std::vector<size_t> myBlockOffsets;
+};
+
+
+#endif // __GSPLAT_CULLER__
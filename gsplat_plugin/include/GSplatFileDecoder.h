@@ -0,0 +1,126 @@
+/***************************************************************************************/
+/*  Filename: GSplatFileDecoder.h                                                      */
+/*  Description: Memory mapped decoding of 3DGS .ply and .splat files                  */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_FILE_DECODER__
+#define __GSPLAT_FILE_DECODER__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// Decodes the splats of a binary little endian 3DGS .ply file, or of an antimatter15 style
+// .splat file, into the attribute values the renderer expects: colours with the DC term
+// turned into rgb, activated opacities, linear scales and normalised xyzw orientations. The
+// file is mapped rather than read, and splats can be decoded in any number of independent
+// ranges, so large files decode in parallel straight from the page cache.
+//
+// Properties missing from a .ply get the values GR_PrimGsplat assumes for missing attributes.
+class GSplatFileDecoder
+{
+public:
+    static constexpr int SH_COEFFICIENT_COUNT = 15;
+    static constexpr size_t BLOCK_SIZE = size_t(1) << 14;
+
+    enum Format
+    {
+        FORMAT_PLY,
+        FORMAT_SPLAT
+    };
+
+    // Where decode writes, each array starting with the first splat decoded
+    struct Target
+    {
+        float *positions = nullptr; // xyz
+        float *colors = nullptr;    // rgb
+        float *alphas = nullptr;
+        float *scales = nullptr;    // xyz, linear
+        float *orients = nullptr;   // xyzw
+        // rgb per splat, only the first getShCoefficientCount() are written
+        float *sh[SH_COEFFICIENT_COUNT] = {};
+    };
+
+    GSplatFileDecoder() = default;
+    ~GSplatFileDecoder();
+
+    GSplatFileDecoder(const GSplatFileDecoder&) = delete;
+    GSplatFileDecoder& operator=(const GSplatFileDecoder&) = delete;
+
+    // Maps the file and reads its header. The format follows from the extension, .splat
+    // or anything else for .ply. On failure getError says why.
+    bool open(const std::string &path);
+    void close();
+
+    const std::string &getError() const { return myError; }
+    Format getFormat() const { return myFormat; }
+    size_t getCount() const { return myCount; }
+    int getShCoefficientCount() const { return myShCoefficientCount; }
+
+    // Decodes splats [begin, end). Safe to call concurrently on disjoint ranges.
+    void decode(const size_t begin, const size_t end, const Target &target) const;
+    // Decodes every splat, in parallel blocks of BLOCK_SIZE.
+    void decodeAll(const Target &target) const;
+
+private:
+    enum PropertyType
+    {
+        PROPERTY_INT8,
+        PROPERTY_UINT8,
+        PROPERTY_INT16,
+        PROPERTY_UINT16,
+        PROPERTY_INT32,
+        PROPERTY_UINT32,
+        PROPERTY_FLOAT32,
+        PROPERTY_FLOAT64
+    };
+
+    // A property of the .ply vertex element, offset in bytes from the start of a vertex
+    struct Field
+    {
+        int offset = -1;
+        PropertyType type = PROPERTY_FLOAT32;
+
+        bool isPresent() const { return offset >= 0; }
+    };
+
+    bool map(const std::string &path);
+    bool parsePlyHeader();
+    bool parseSplatLayout();
+    bool fail(const std::string &error);
+
+    static float readField(const char *vertex, const Field &field);
+    void decodePly(const size_t begin, const size_t end, const Target &target) const;
+    void decodeSplat(const size_t begin, const size_t end, const Target &target) const;
+
+    const char *myData = nullptr;
+    size_t mySize = 0;
+    bool myIsMapped = false;
+    std::vector<char> myFallback; // the file content when it could not be mapped
+
+    std::string myError;
+    Format myFormat = FORMAT_PLY;
+    size_t myCount = 0;
+    size_t myBodyOffset = 0;
+    size_t myStride = 0;
+    int myShCoefficientCount = 0;
+
+    Field myPosition[3];
+    Field myDc[3];
+    Field myRgb[3]; // 8 bit colours of plain point clouds, used without DC terms
+    Field myOpacity;
+    Field myScale[3];
+    Field myRotation[4]; // wxyz
+    Field myRest[3 * SH_COEFFICIENT_COUNT];
+    int myRestPerChannel = 0; // f_rest_ properties per colour channel, may be more than decoded
+};
+
+
+#endif // __GSPLAT_FILE_DECODER__
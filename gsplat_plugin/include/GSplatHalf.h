@@ -0,0 +1,102 @@
+/***************************************************************************************/
+/*  Filename: GSplatHalf.h                                                             */
+/*  Description: HDK independent half float conversions for the GSplat Plugin          */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_HALF__
+#define __GSPLAT_HALF__
+
+#include <cstdint>
+#include <cstring>
+
+
+// IEEE 754 binary16 stored as raw bits, the same layout as fpreal16.
+inline float gsplatHalfToFloat(const uint16_t h)
+{
+    const uint32_t sign = uint32_t(h & 0x8000u) << 16;
+    uint32_t exponent = (h >> 10) & 0x1Fu;
+    uint32_t mantissa = h & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0x1Fu)
+    {
+        bits = sign | 0x7F800000u | (mantissa << 13); // inf / nan
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa != 0)
+    {
+        // Subnormal, renormalise
+        exponent = 113;
+        while (!(mantissa & 0x400u))
+        {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+    else
+    {
+        bits = sign;
+    }
+
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Round to nearest even, overflows to infinity.
+inline uint16_t gsplatFloatToHalf(const float f)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+
+    const uint16_t sign = uint16_t((bits >> 16) & 0x8000u);
+    const uint32_t absBits = bits & 0x7FFFFFFFu;
+
+    if (absBits >= 0x7F800000u)
+    {
+        return sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u); // inf / nan
+    }
+    if (absBits >= 0x477FF000u)
+    {
+        return sign | 0x7C00u; // too large, rounds to infinity
+    }
+    if (absBits < 0x38800000u)
+    {
+        // Subnormal or zero
+        if (absBits < 0x33000000u)
+        {
+            return sign;
+        }
+        const uint32_t exponent = absBits >> 23;
+        const uint32_t mantissa = (absBits & 0x7FFFFFu) | 0x800000u;
+        const uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u)))
+        {
+            ++half;
+        }
+        return sign | uint16_t(half);
+    }
+
+    uint32_t half = ((absBits - 0x38000000u) >> 13);
+    const uint32_t remainder = absBits & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+    {
+        ++half;
+    }
+    return sign | uint16_t(half);
+}
+
+
+#endif // __GSPLAT_HALF__
@@ -0,0 +1,78 @@
+/***************************************************************************************/
+/*  Filename: GSplatLodBuilder.h                                                       */
+/*  Description: Hierarchy of moment matched gaussians over the splats of a primitive  */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_LOD_BUILDER__
+#define __GSPLAT_LOD_BUILDER__
+
+#include <cstddef>
+#include <vector>
+
+
+// Builds a level of detail hierarchy bottom up. The splats are the leaves, every level groups
+// up to BRANCHING nodes of the level below that are consecutive along a Morton curve, and
+// replaces each group by one gaussian matching its moments: weighted mean and covariance,
+// the weights being the opacities times the surface areas of the children. The parent is as
+// opaque as it needs to be to cover the same area, and other attributes (colour, SH) are
+// blended with the same weights, see getChildWeights.
+//
+// Every node also gets an extent, the largest 3 sigma radius in its subtree, so that the
+// renderer can pick a cut through the hierarchy: a node is drawn when it projects to at most
+// the error target but its parent does not, see GSplatCuller::isInLodCut.
+//
+// Nodes are numbered after the leaves, level by level. The build is parallel and its result
+// does not depend on the number of threads.
+class GSplatLodBuilder
+{
+public:
+    static constexpr int BRANCHING = 8;
+
+    struct Gaussian
+    {
+        float position[3];
+        float scale[3];   // linear
+        float orient[4];  // xyzw
+        float alpha;
+    };
+
+    // positions, scales and orients hold count triplets, triplets and quadruplets.
+    void build(const float *positions, const float *scales, const float *orients, const float *alphas, const size_t count);
+
+    size_t getLeafCount() const { return myLeafCount; }
+    // Nodes above the leaves, node i is number getLeafCount() + i
+    const std::vector<Gaussian> &getNodes() const { return myNodes; }
+    // Nodes of level l (leaves being level 0) are [getLevelBegins()[l - 1], getLevelBegins()[l])
+    const std::vector<size_t> &getLevelBegins() const { return myLevelBegins; }
+
+    // Children of node i are getChildren()[getChildBegins()[i] .. getChildBegins()[i + 1]),
+    // as leaf or node numbers, along with their normalised blending weights
+    const std::vector<size_t> &getChildBegins() const { return myChildBegins; }
+    const std::vector<size_t> &getChildren() const { return myChildren; }
+    const std::vector<float> &getChildWeights() const { return myChildWeights; }
+
+    // Per leaf and node number. Leaves have a zero extent, the root an infinite parent extent.
+    const std::vector<float> &getExtents() const { return myExtents; }
+    const std::vector<float> &getParentExtents() const { return myParentExtents; }
+
+    // Moment matching of a group of gaussians, weights are normalised into outWeights.
+    static Gaussian merge(const Gaussian *const *children, const int childCount, float *outWeights);
+
+private:
+    size_t myLeafCount = 0;
+    std::vector<Gaussian> myNodes;
+    std::vector<size_t> myLevelBegins;
+    std::vector<size_t> myChildBegins;
+    std::vector<size_t> myChildren;
+    std::vector<float> myChildWeights;
+    std::vector<float> myExtents;
+    std::vector<float> myParentExtents;
+};
+
+
+#endif // __GSPLAT_LOD_BUILDER__
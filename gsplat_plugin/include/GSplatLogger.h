@@ -14,6 +14,7 @@
 #include <string>
 #include <unordered_set>
 #include <cstdarg>
+#include <cstdint>
 
 
 class GSplatLogger 
@@ -31,7 +32,7 @@ public:
     }
 
     static void log(const LogLevel level, const char* format, ...);  // Updated to const char* for variadic handling
-    static std::string formatInteger(const int number, const char separator = ',');
+    static std::string formatInteger(const int64_t number, const char separator = ',');
 
 protected:
     GSplatLogger() {}
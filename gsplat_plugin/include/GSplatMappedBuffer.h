@@ -0,0 +1,74 @@
+/***************************************************************************************/
+/*  Filename: GSplatMappedBuffer.h                                                     */
+/*  Description: Zero initialised memory on the heap or in a mapped scratch file       */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_MAPPED_BUFFER__
+#define __GSPLAT_MAPPED_BUFFER__
+
+#include <cstddef>
+#include <string>
+
+
+// Zero initialised memory for large splat arrays. When GSPLAT_PAGING_DIR names a directory,
+// buffers of at least FILE_BACKED_SIZE_MIN bytes live in an unlinked scratch file there,
+// mapped into memory, so that the operating system pages them from disk instead of holding
+// them in RAM. Otherwise, or when the file cannot be created, they live on the heap.
+class GSplatMappedBuffer
+{
+public:
+    static constexpr size_t FILE_BACKED_SIZE_MIN = size_t(1) << 20; // bytes
+
+    GSplatMappedBuffer() = default;
+    ~GSplatMappedBuffer();
+
+    GSplatMappedBuffer(const GSplatMappedBuffer&) = delete;
+    GSplatMappedBuffer& operator=(const GSplatMappedBuffer&) = delete;
+
+    // Replaces the content with byteCount zeroed bytes. Returns false, leaving the buffer
+    // empty, if there is no memory for them.
+    bool allocate(const size_t byteCount);
+    void free();
+
+    void *data() { return myData; }
+    const void *data() const { return myData; }
+    size_t size() const { return mySize; }
+    bool isFileBacked() const { return myIsFileBacked; }
+
+    // Where scratch files go, empty when buffers stay on the heap
+    static std::string getFileDirectory();
+
+private:
+    void *myData = nullptr;
+    size_t mySize = 0;
+    bool myIsFileBacked = false;
+};
+
+
+// An array of count zero initialised values of a trivially copyable type, in a GSplatMappedBuffer.
+template <typename T>
+class GSplatMappedArray
+{
+public:
+    explicit GSplatMappedArray(const size_t count)
+    {
+        myCount = myBuffer.allocate(count * sizeof(T)) ? count : 0;
+    }
+
+    T *data() { return static_cast<T*>(myBuffer.data()); }
+    const T *data() const { return static_cast<const T*>(myBuffer.data()); }
+    size_t size() const { return myCount; }
+    bool empty() const { return myCount == 0; }
+
+private:
+    GSplatMappedBuffer myBuffer;
+    size_t myCount = 0;
+};
+
+
+#endif // __GSPLAT_MAPPED_BUFFER__
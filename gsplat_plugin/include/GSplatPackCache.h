@@ -0,0 +1,109 @@
+/***************************************************************************************/
+/*  Filename: GSplatPackCache.h                                                        */
+/*  Description: Memory mapped on disk cache of packed splat data                      */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_PACK_CACHE__
+#define __GSPLAT_PACK_CACHE__
+
+#include "GSplatPacker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+// A file holding what GSplatRenderer packs for one store: the CPU arrays culling and sorting
+// read, the texels of the float or the compact encoding and the SH of every degree, in the
+// spatial order of the atlas and padded to whole chunks. When GSPLAT_CACHE_DIR names a
+// directory, the packing of a store is written there once, keyed by a hash of its content,
+// and later sessions map the file and copy its blocks as they are instead of packing again.
+//
+// Positions in the texels are relative to the origin recorded in the file. Blocks start on
+// page boundaries so that they can be handed to the driver straight from the mapping.
+class GSplatPackCache
+{
+public:
+    // 2: the float texels hold the 3D covariance instead of scale and orient
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    enum Block
+    {
+        POINTS,       // float xyz per slot
+        CULL_RADII,   // float per slot
+        ALPHAS,       // float per slot
+        LOD_EXTENTS,  // float pair per slot
+        TEXELS,       // float texels, or compact words, per slot
+        CHUNK_BOUNDS, // compact encoding only, per chunk
+        SH_DEGREE_1,  // halves per slot, see GSplatPacker::packSh
+        SH_DEGREE_2,
+        SH_DEGREE_3,
+        BLOCK_COUNT
+    };
+
+    struct Layout
+    {
+        uint64_t count = 0;
+        uint64_t slotCount = 0; // count rounded up to whole chunks
+        uint64_t chunkSize = 0;
+        uint32_t isCompact = 0;
+        uint32_t hasSh = 0;
+        float origin[3] = { 0.0f, 0.0f, 0.0f };
+        uint64_t blockSizes[BLOCK_COUNT] = {}; // bytes
+    };
+
+    ~GSplatPackCache();
+
+    GSplatPackCache(const GSplatPackCache&) = delete;
+    GSplatPackCache& operator=(const GSplatPackCache&) = delete;
+
+    // Where cache files go, empty when caching is off
+    static std::string getDirectory();
+
+    // 64 bit hash of everything packing reads from the first count splats of source, computed
+    // in parallel blocks. Never 0, which stands for an unknown content.
+    static uint64_t computeContentHash(const GSplatSourceView &source, const size_t count);
+
+    static std::string makePath(const uint64_t contentHash, const bool isCompact);
+
+    // Maps a committed cache file, null when there is none or it was written by another version.
+    static std::shared_ptr<GSplatPackCache> open(const std::string &path);
+
+    // A new file with the blocks of layout, to be filled in through getBlock and then
+    // committed. Null if it cannot be created.
+    static std::shared_ptr<GSplatPackCache> create(const std::string &path, const Layout &layout);
+
+    // Moves a created file into place, where open finds it. Other sessions never see a
+    // partially written file.
+    bool commit();
+
+    const Layout &getLayout() const { return myLayout; }
+    void *getBlock(const Block block) { return myBlocks[block]; }
+    const void *getBlock(const Block block) const { return myBlocks[block]; }
+
+private:
+    // Blocks start on boundaries of this many bytes
+    static constexpr size_t BLOCK_ALIGNMENT = 4096;
+
+    GSplatPackCache() = default;
+
+    // Offsets of the blocks of layout, returns the file size
+    static size_t computeBlockOffsets(const Layout &layout, uint64_t outOffsets[BLOCK_COUNT]);
+    bool mapFile(const int fd, const size_t size, const bool isWritable);
+
+    Layout myLayout;
+    void *myBlocks[BLOCK_COUNT] = {};
+    void *myData = nullptr;
+    size_t mySize = 0;
+    std::string myPath;
+    std::string myTemporaryPath; // while created and not yet committed
+};
+
+
+#endif // __GSPLAT_PACK_CACHE__
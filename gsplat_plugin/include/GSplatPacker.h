@@ -0,0 +1,98 @@
+/***************************************************************************************/
+/*  Filename: GSplatPacker.h                                                           */
+/*  Description: HDK independent packing of splat data into texture layouts           */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_PACKER__
+#define __GSPLAT_PACKER__
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Raw views on the per splat arrays of one registry entry. Half precision values are
+// raw binary16 bits (the fpreal16 layout).
+struct GSplatSourceView
+{
+    size_t count = 0;
+    const float *positions = nullptr;  // xyz
+    const uint16_t *colors = nullptr;  // rgb, half
+    const float *alphas = nullptr;
+    const uint16_t *scales = nullptr;  // xyz, half
+    const uint16_t *orients = nullptr; // xyzw, half
+    // One 4x4 row-major half matrix per splat and colour channel, holding the 15 SH
+    // coefficients of degrees 1 to 3 in order. Null when there is no SH data.
+    const uint16_t *shx = nullptr;
+    const uint16_t *shy = nullptr;
+    const uint16_t *shz = nullptr;
+    // Extent and parent extent of every splat in its LOD hierarchy, see GSplatLodBuilder.
+    // Null when the splats are not part of one.
+    const float *lodExtents = nullptr;
+};
+
+// Destination buffers, indexed by the global splat index.
+struct GSplatPackTarget
+{
+    float *points = nullptr;                    // world space xyz, used for sorting and culling
+    float *cullRadii = nullptr;
+    float *alphas = nullptr;
+    float *lodExtents = nullptr;                // extent and parent extent, optional
+    float *posColorAlphaCovariance = nullptr;   // POS_COLOR_ALPHA_COVARIANCE_TEXELS rgba texels, optional
+    float *posColorAlphaScaleOrient = nullptr;  // POS_COLOR_ALPHA_SCALE_ORIENT_TEXELS rgba texels, optional, what GSplatQuantizer encodes
+};
+
+
+class GSplatPacker
+{
+public:
+    // Position, colour and alpha, then the 3D covariance of GSplatProjector::computeCovariance
+    // in place of scale and orient, which then only the compact encoding keeps
+    static constexpr int POS_COLOR_ALPHA_COVARIANCE_TEXELS = 4;
+    static constexpr int POS_COLOR_ALPHA_SCALE_ORIENT_TEXELS = 4;
+    static constexpr int SH_COEFFICIENT_COUNT = 15;
+
+    // Each SH degree has its own texture, so that only the degrees in use take memory. The rgb
+    // coefficients of a degree are stored as consecutive halves, zero padded to a power of two
+    // number of texels: 3 coefficients in 4 rgb texels, 5 in 4 rgba texels and 7 in 8 rgb texels.
+    static constexpr int SH_DEGREE_COUNT = 3;
+    static constexpr int SH_DEGREE_FIRST_COEFFICIENT[SH_DEGREE_COUNT] = { 0, 3, 8 };
+    static constexpr int SH_DEGREE_COEFFICIENTS[SH_DEGREE_COUNT] = { 3, 5, 7 };
+    static constexpr int SH_DEGREE_TEXELS[SH_DEGREE_COUNT] = { 4, 4, 8 };
+    static constexpr int SH_DEGREE_CHANNELS[SH_DEGREE_COUNT] = { 3, 4, 3 };
+
+    // Halves per splat in the texture of a degree, from 1 to SH_DEGREE_COUNT
+    static constexpr int getShDegreeHalfCount(const int degree)
+    {
+        return SH_DEGREE_TEXELS[degree - 1] * SH_DEGREE_CHANNELS[degree - 1];
+    }
+
+    // Packs the first count splats of source into target, starting at global index
+    // targetOffset, into whichever texel layouts target has. Positions in the texture are
+    // stored relative to origin.
+    // When given, destinations remaps global indices, splat i then lands at destinations[targetOffset + i].
+    static void pack(
+        const GSplatSourceView &source,
+        const size_t count,
+        const float origin[3],
+        const GSplatPackTarget &target,
+        const size_t targetOffset,
+        const int *destinations = nullptr);
+
+    // Packs the SH coefficients of one degree of the first count splats of source, which
+    // must have SH data, with the same destinations as pack.
+    static void packSh(
+        const GSplatSourceView &source,
+        const size_t count,
+        const int degree,
+        uint16_t *target,
+        const size_t targetOffset = 0,
+        const int *destinations = nullptr);
+};
+
+
+#endif // __GSPLAT_PACKER__
@@ -0,0 +1,90 @@
+/***************************************************************************************/
+/*  Filename: GSplatPageCache.h                                                        */
+/*  Description: LRU cache of atlas pages in a budget of GPU page slots                */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_PAGE_CACHE__
+#define __GSPLAT_PAGE_CACHE__
+
+#include "GSplatChunker.h"
+#include "GSplatCuller.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// The atlas is cut into pages of PAGE_SIZE consecutive slots, whole chunks of spatially close
+// splats. When the GPU memory budget has fewer page slots than the atlas has pages, only the
+// pages that matter most for the current view are resident, each in some slot, and the rest
+// waits on the CPU. Pages are ranked every frame by how much of the screen their chunks cover,
+// a bounded number of them gets loaded per frame and the slots to load them into are taken
+// from the resident pages that went longest without being in view.
+//
+// With at least as many slots as pages, every page lives in the slot of the same index and
+// nothing is ever paged.
+class GSplatPageCache
+{
+public:
+    static constexpr size_t PAGE_SIZE = size_t(1) << 14; // slots
+    static constexpr size_t CHUNKS_PER_PAGE = PAGE_SIZE / GSplatChunker::CHUNK_SIZE;
+
+    struct Load
+    {
+        size_t page;
+        size_t slot;
+        int64_t evictedPage; // -1 when the slot was free
+    };
+
+    // Forgets every resident page, pageCount pages then share slotCount slots.
+    void reset(const size_t pageCount, const size_t slotCount);
+
+    bool isPaging() const { return mySlotCount < myPageCount; }
+    size_t getPageCount() const { return myPageCount; }
+    size_t getSlotCount() const { return mySlotCount; }
+
+    // For every page, its slot or -1 when it is not resident
+    const std::vector<int> &getPageTable() const { return myPageSlots; }
+    int getSlot(const size_t page) const { return myPageSlots[page]; }
+
+    // Writes the importance of every page into outImportance: the squared projected radii, in
+    // pixels, of its chunks that pass culling, summed. Zero for pages with nothing in view.
+    // The chunks past those of the pages are copies of the splats of the page copiedPages has
+    // for them, placed elsewhere, and count towards that page.
+    void computeImportance(
+        const std::vector<GSplatChunker::Chunk> &chunks,
+        const std::vector<int> &copiedPages,
+        const GSplatCuller::Frustum &frustum,
+        std::vector<float> &outImportance) const;
+
+    // Makes up to maxLoads of the pages with some importance resident, most important first,
+    // and writes them into outLoads. They count as resident right away, it is up to the caller
+    // to copy them into their slots before drawing. A page in view only gives its slot to one
+    // EVICTION_IMPORTANCE_RATIO times as important, so that similar pages do not take turns.
+    void plan(const std::vector<float> &importance, const size_t maxLoads, std::vector<Load> &outLoads);
+
+    // True when the last plan left out pages with some importance only because of maxLoads
+    bool hasPendingLoads() const { return myHasPendingLoads; }
+
+private:
+    static constexpr float EVICTION_IMPORTANCE_RATIO = 2.0f;
+
+    size_t myPageCount = 0;
+    size_t mySlotCount = 0;
+    std::vector<int> myPageSlots;
+    std::vector<int64_t> mySlotPages; // -1 for a free slot
+    std::vector<uint64_t> myLastImportantFrames; // per page, 0 for never
+    uint64_t myFrame = 0;
+    bool myHasPendingLoads = false;
+
+    std::vector<size_t> myCandidates;
+    std::vector<size_t> myVictims;
+};
+
+
+#endif // __GSPLAT_PAGE_CACHE__
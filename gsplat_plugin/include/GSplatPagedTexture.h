@@ -0,0 +1,79 @@
+/***************************************************************************************/
+/*  Filename: GSplatPagedTexture.h                                                     */
+/*  Description: Texture holding the resident pages of an out of core atlas            */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_PAGED_TEXTURE__
+#define __GSPLAT_PAGED_TEXTURE__
+
+#include <RE/RE_RenderContext.h>
+#include <RE/RE_Texture.h>
+
+#include "GSplatStagingBuffer.h"
+#include "GSplatMappedBuffer.h"
+#include "GSplatPageCache.h"
+#include "GSplatTextureLayout.h"
+
+#include <cstddef>
+
+
+// Texels of an atlas texture, addressed by atlas slot whether or not the atlas is paged. When
+// it is, the texture only has room for the page slots of the GSplatPageCache, and every page
+// of the atlas lives in a CPU side backing store that it gets copied from once it is made
+// resident. Packing writes into the backing store then, and only the resident pages it
+// touched get uploaded at commit.
+//
+// Without a paging cache it is a thin layer over the staging buffer it is given.
+class GSplatPagedTexture
+{
+public:
+    GSplatPagedTexture();
+
+    GSplatPagedTexture(const GSplatPagedTexture&) = delete;
+    GSplatPagedTexture& operator=(const GSplatPagedTexture&) = delete;
+
+    // tex is laid out as layout, with texels of texelSize bytes and texelsPerPage texels for
+    // every page of pageCache. A null pageCache, or one that is not paging, stands for an atlas
+    // that is fully resident. The backing store starts out zeroed.
+    void configure(
+        RE_Texture *tex,
+        const GSplatTextureLayout &layout,
+        GSplatStagingBuffer *staging,
+        const size_t texelSize,
+        const size_t texelsPerPage,
+        const GSplatPageCache *pageCache);
+
+    bool isPaged() const { return myPageCache != nullptr; }
+
+    // Memory for atlas texels [texelBegin, texelEnd), valid until commit. When paged it holds
+    // what was last written there, otherwise its content is undefined.
+    void *map(RE_RenderContext r, const size_t texelBegin, const size_t texelEnd);
+
+    // Copies the texels written since map into the texture, the resident ones when paged.
+    void commit(RE_RenderContext r);
+
+    // Copies a page that was just made resident into its slot.
+    void uploadPage(RE_RenderContext r, const size_t page);
+
+    void free();
+
+private:
+    RE_Texture *myTex;
+    GSplatTextureLayout myLayout;
+    GSplatStagingBuffer *myStaging;
+    size_t myTexelSize;
+    size_t myTexelsPerPage;
+    const GSplatPageCache *myPageCache; // null when not paging
+    GSplatMappedBuffer myBacking;
+
+    size_t myMappedBegin;
+    size_t myMappedEnd;
+};
+
+
+#endif // __GSPLAT_PAGED_TEXTURE__
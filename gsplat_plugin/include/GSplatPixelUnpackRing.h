@@ -0,0 +1,60 @@
+/***************************************************************************************/
+/*  Filename: GSplatPixelUnpackRing.h                                                  */
+/*  Description: Ring of pixel unpack buffers for streaming texture uploads            */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_PIXEL_UNPACK_RING__
+#define __GSPLAT_PIXEL_UNPACK_RING__
+
+#include <RE/RE_RenderContext.h>
+#include <RE/RE_Texture.h>
+#include <RE/RE_OGLBuffer.h>
+
+#include "GSplatTextureLayout.h"
+
+#include <cstddef>
+
+
+// Uploads texels of a single channel 32 bit texture through a small ring of pixel unpack
+// buffers. The texel copy is queued on the GPU instead of being done synchronously from
+// client memory, and cycling through the ring avoids waiting on a buffer the GPU may still
+// be reading from the previous frames.
+class GSplatPixelUnpackRing
+{
+public:
+    static constexpr int RING_SIZE = 3;
+
+    GSplatPixelUnpackRing();
+    ~GSplatPixelUnpackRing();
+
+    GSplatPixelUnpackRing(const GSplatPixelUnpackRing&) = delete;
+    GSplatPixelUnpackRing& operator=(const GSplatPixelUnpackRing&) = delete;
+
+    // Copies texels [texelBegin, texelEnd) of data, the whole content of a texture array laid
+    // out as layout, into the same texels of tex. Returns false if no buffer could be mapped,
+    // the caller should then fall back to a regular upload.
+    bool uploadTexels(
+        RE_RenderContext r,
+        RE_Texture *tex,
+        const int *data,
+        const GSplatTextureLayout &layout,
+        const size_t texelBegin,
+        const size_t texelEnd);
+
+    void free();
+
+private:
+    bool ensureCapacity(RE_RenderContext r, const size_t elementCount);
+
+    RE_OGLBuffer *myBuffers[RING_SIZE];
+    size_t myCapacity; // in elements, per buffer
+    int myNextBuffer;
+};
+
+
+#endif // __GSPLAT_PIXEL_UNPACK_RING__
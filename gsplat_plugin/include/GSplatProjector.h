@@ -0,0 +1,63 @@
+/***************************************************************************************/
+/*  Filename: GSplatProjector.h                                                        */
+/*  Description: HDK independent per splat covariance and projection                   */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_PROJECTOR__
+#define __GSPLAT_PROJECTOR__
+
+#include "GSplatSimd.h"
+
+
+// The per splat half of the main vertex shader, on the CPU. The 3D covariance of a splat only
+// depends on its scale and orient, so it is computed once when packing. Its projection, the
+// two screen axes of the quad, is computed once per splat and frame, by the vertex shader
+// before the geometry shader expands the quad, and here for GSplatRasterizer.
+//
+// project works on GSplatFloat4::LANE_COUNT splats at a time and follows the GLSL of
+// GSplatCoreLib, CalcCovariance2D and DecomposeCovariance, step by step. GSplatCoreMath.h has
+// the same maths one splat at a time and term for term, to check this against.
+class GSplatProjector
+{
+public:
+    static constexpr int LANE_COUNT = GSplatFloat4::LANE_COUNT;
+    static constexpr int COVARIANCE_FLOATS = 6;
+
+    // Upper triangle of the 3D covariance, the sigma of CalcCovariance3D, as 00 01 02 11 12 22.
+    // orient is xyzw, scale linear.
+    static void computeCovariance(const float orient[4], const float scale[3], float covariance[COVARIANCE_FLOATS]);
+
+    // The uniforms the projection reads. The matrices are row-major for row vectors, as
+    // returned by RE_Render::getMatrix, and the object transform is the identity.
+    struct Camera
+    {
+        float view[16];
+        float projection[16];
+        float screenWidth;
+    };
+
+    // LANE_COUNT splats, structure of arrays
+    struct Splats
+    {
+        float position[3][LANE_COUNT];
+        float covariance[COVARIANCE_FLOATS][LANE_COUNT];
+    };
+
+    struct Projection
+    {
+        float clip[4][LANE_COUNT]; // centre in clip space, before the y flip of the vertex shader
+        float axis1[2][LANE_COUNT]; // pixels
+        float axis2[2][LANE_COUNT];
+    };
+
+    // The splats behind the camera get axes too, it is up to the caller to drop them
+    static void project(const Camera &camera, const Splats &splats, Projection &projection);
+};
+
+
+#endif // __GSPLAT_PROJECTOR__
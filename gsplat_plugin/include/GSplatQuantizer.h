@@ -0,0 +1,73 @@
+/***************************************************************************************/
+/*  Filename: GSplatQuantizer.h                                                        */
+/*  Description: Compact 16 byte per splat encoding for the GSplat Plugin              */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_QUANTIZER__
+#define __GSPLAT_QUANTIZER__
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Quantizes splats from the float layout of GSplatPacker (4 rgba texels) into a single
+// RGBA32UI texel, a quarter of the size. Positions and scales are stored relative to the
+// bounds of the chunk the splat belongs to, chunks being runs of chunkSize splats:
+//   word 0: position x (16) | position y (16)
+//   word 1: position z (16) | red (8) | green (8)
+//   word 2: blue (8) | opacity (8) | log scale x (7) | log scale y (7) | orient largest axis (2)
+//   word 3: log scale z (7) | the three other orient components (8 each)
+// Orientations use the smallest three encoding: the largest component is made positive and
+// dropped, the others lie within +-1/sqrt(2). Colours and opacities are clamped to [0, 1].
+// GSplatMainVertexShader decodes the same layout.
+class GSplatQuantizer
+{
+public:
+    static constexpr int ENCODED_WORDS = 4;
+
+    // Per chunk rgba32f texels: position min, position extent, log scale min, log scale extent
+    static constexpr int CHUNK_BOUNDS_TEXELS = 4;
+
+    static constexpr int POSITION_BITS = 16;
+    static constexpr int COLOR_BITS = 8;
+    static constexpr int LOG_SCALE_BITS = 7;
+    static constexpr int ORIENT_BITS = 8;
+
+    // Largest errors of a decoded splat against its source, in quantization steps, except
+    // for orientations which are an angle in radians.
+    struct RoundTripError {
+        float position = 0.0f;
+        float color = 0.0f;
+        float alpha = 0.0f;
+        float logScale = 0.0f;
+        float orientAngle = 0.0f;
+    };
+
+    // Encodes the slotCount splats of texels, chunk by chunk. Only the first count are
+    // splats, the slots after them are padding and get zeroed, so are the bounds of chunks
+    // without any splat. slotCount must be a multiple of chunkSize.
+    static void encode(
+        const float *texels,
+        const size_t count,
+        const size_t slotCount,
+        const size_t chunkSize,
+        uint32_t *outEncoded,
+        float *outChunkBounds);
+
+    // Decodes one splat back into the 4 texel float layout, given the bounds of its chunk.
+    static void decode(const uint32_t *encoded, const float *chunkBounds, float *outTexels);
+
+    // Encodes and decodes the first count splats of texels and reports the largest errors.
+    static RoundTripError measureRoundTripError(const float *texels, const size_t count, const size_t chunkSize);
+
+    // Whether the errors stay within what the bit depths above allow for.
+    static bool isWithinTolerance(const RoundTripError &error);
+};
+
+
+#endif // __GSPLAT_QUANTIZER__
@@ -0,0 +1,88 @@
+/***************************************************************************************/
+/*  Filename: GSplatRasterizer.h                                                       */
+/*  Description: HDK independent tiled CPU rasterizer for offline renders              */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_RASTERIZER__
+#define __GSPLAT_RASTERIZER__
+
+#include "GSplatPacker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Draws splats on the CPU, without a GL context, into the image the viewport would show for
+// the same camera: every splat is projected with the shader maths (GSplatCoreMath.h), covers
+// the same quad, and is blended front to back into premultiplied RGBA just like the main
+// shaders do. Meant for farm renders and for golden image regression tests of the maths.
+//
+// The image is split in TILE_SIZE square tiles. Splats are binned into the tiles their quad
+// overlaps, each tile sorts its own list by distance to the camera and then blends it in
+// structure of arrays form, four pixels at a time (GSplatFloat4). Tiles are independent, both
+// sorting and blending run per tile in parallel, and a tile stops once all of its pixels are
+// opaque.
+class GSplatRasterizer
+{
+public:
+    static constexpr int TILE_SIZE = 16;
+    static constexpr int TILE_PIXELS = TILE_SIZE * TILE_SIZE;
+    // Pixels past this alpha have no visible room left for splats further back
+    static constexpr float SATURATED_ALPHA = 0.9999f;
+
+    // The uniforms the main shaders get from the viewport. The matrices are row-major for
+    // row vectors (p * M), as returned by RE_Render::getMatrix, and transform from world space:
+    // the splats are drawn with an identity object transform.
+    struct Camera
+    {
+        float view[16];
+        float projection[16];
+        int width = 0;
+        int height = 0;
+        int shOrder = 0; // clamped to what the splats carry
+    };
+
+    // Fills rgba with width * height premultiplied float RGBA pixels, bottom row first as
+    // glReadPixels and IMG_File return them. Splats behind the camera or clipped by the near
+    // and far planes are dropped, the same as the GL path does.
+    void render(const GSplatSourceView &source, const Camera &camera, std::vector<float> &rgba);
+
+private:
+    // A splat as the fragment shader sees it: the quad coordinates of a pixel centre (x, y) in
+    // window coordinates are (x - centerX, y - centerY) times the rows quadX and quadY.
+    struct Projected
+    {
+        float centerX, centerY;
+        float quadX[2];
+        float quadY[2];
+        float color[3];
+        float opacity;
+        float extent[2];  // half size of the quad bounds, in pixels
+        int tileBegin[2]; // first tile covered in x and y
+        int tileEnd[2];   // one past the last
+    };
+
+    void project(const GSplatSourceView &source, const Camera &camera);
+    void binTiles();
+    void blendTile(const int tile, float *rgba) const;
+
+    int myWidth = 0;
+    int myHeight = 0;
+    int myTileCountX = 0;
+    int myTileCountY = 0;
+
+    std::vector<Projected> myProjected;
+    std::vector<uint32_t> myDistanceKeys;  // per splat, sortable bits of the squared distance to the camera
+    std::vector<uint8_t> myIsDrawn;        // per splat
+    std::vector<size_t> myTileOffsets;     // per tile, into myTileEntries, with one past the end
+    std::vector<uint64_t> myTileEntries;   // distance key and splat index of every tile overlap
+};
+
+
+#endif // __GSPLAT_RASTERIZER__
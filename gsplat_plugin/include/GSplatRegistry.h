@@ -0,0 +1,124 @@
+/***************************************************************************************/
+/*  Filename: GSplatRegistry.h                                                         */
+/*  Description: HDK independent bookkeeping of the splat sets requested for render    */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_REGISTRY__
+#define __GSPLAT_REGISTRY__
+
+#include "GSplatPacker.h"
+#include "GSplatStore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// Keeps track of every splat set registered by the GR primitives, which ones asked to be
+// rendered in the current frame, and which ones the render geometry was built from.
+//
+// Entries live in dense slots and are referred to by handles, so that the per frame calls
+// never look up or build strings. A slot gets a new generation once its entry is dropped,
+// the handles to the dropped entry then resolve to nothing.
+//
+// registerEntry, flushOwnerOf and markActive lock, and may be called concurrently from the
+// updates of several GR primitives. Everything else takes no lock: find, isAnyActive,
+// isRenderSetCurrent, captureRenderSet, getRenderSet and advanceFrame are for the render
+// thread once the updates are done, and must never overlap them. registerEntry may grow the
+// slots, which moves them, and dropping an entry frees it along with what find returned.
+class GSplatRegistry
+{
+public:
+    typedef int64_t Version[4];
+
+    // Slot index in the low 32 bits, generation of the slot in the high ones. Never 0.
+    typedef uint64_t Handle;
+    static constexpr Handle INVALID_HANDLE = 0;
+
+    static constexpr size_t INSTANCE_TRANSFORM_SIZE = 16;
+
+    struct Entry {
+        std::string key; // id the entry was registered under, the key of its store
+        const void *owner = nullptr; // the detail the splats come from
+        Version version = {0, 0, 0, 0};
+        GSplatStore::Handle store; // keeps the arrays source looks at alive
+        GSplatSourceView source;
+        float origin[3] = {0.0f, 0.0f, 0.0f};
+        // INSTANCE_TRANSFORM_SIZE floats per instance, each a row vector matrix as in UT_Matrix4F.
+        // Empty when the splats are drawn once, where they are.
+        std::vector<float> instanceTransforms;
+        int64_t lastActiveFrame = -1;
+    };
+
+    // Adds or refreshes the entry for key, whose handle stays the same from one refresh to
+    // the next. Entries of the same owner registered with another version are stale and get dropped.
+    Handle registerEntry(
+        const std::string &key,
+        const void *owner,
+        const Version &version,
+        const GSplatStore::Handle &store,
+        const float origin[3],
+        const std::vector<float> &instanceTransforms);
+
+    // Drops every entry that shares the owner of handle.
+    void flushOwnerOf(const Handle handle);
+
+    // Requests the entry to be rendered this frame.
+    void markActive(const Handle handle);
+
+    bool isAnyActive() const { return !myActiveSlots.empty(); }
+
+    // Whether the entries requested this frame are the ones the render set was captured from.
+    bool isRenderSetCurrent() const;
+
+    // Captures the entries requested this frame as the render set, returned in handle order.
+    const std::vector<Handle>& captureRenderSet();
+
+    const std::vector<Handle>& getRenderSet() const { return myRenderSet; }
+
+    const Entry* find(const Handle handle) const;
+
+    // Clears the requests, to be called once the frame is rendered.
+    void advanceFrame();
+
+private:
+    struct Slot {
+        uint32_t generation = 1;
+        bool isActive = false;
+        bool isInRenderSet = false;
+        std::unique_ptr<Entry> entry; // null while the slot is free
+    };
+
+    static Handle makeHandle(const uint32_t index, const uint32_t generation)
+    {
+        return (Handle(generation) << 32) | index;
+    }
+    // Index of the slot holding the entry of handle, -1 when the entry was dropped
+    int64_t findSlot(const Handle handle) const;
+    void dropSlot(const uint32_t index);
+
+    std::mutex myMutex; // guards registration and requests
+    std::vector<Slot> mySlots;
+    std::vector<uint32_t> myFreeSlots;
+    std::unordered_map<std::string, uint32_t> mySlotsByKey;
+    std::unordered_map<const void*, std::vector<uint32_t>> mySlotsByOwner;
+
+    std::vector<uint32_t> myActiveSlots; // requested this frame, in request order
+    std::vector<Handle> myRenderSet;
+    // Whether an entry requested this frame is outside the render set, or one of the render
+    // set was dropped. Along with the number of requests, tells whether the render set is current.
+    bool myIsRenderSetDirty = false;
+    int64_t myFrame = 0;
+};
+
+
+#endif // __GSPLAT_REGISTRY__
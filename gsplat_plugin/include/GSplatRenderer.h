@@ -13,17 +13,40 @@
 
 #include <SYS/SYS_Types.h>
 #include <UT/UT_Vector3.h>
+#include <UT/UT_Matrix3.h>
 #include <UT/UT_Map.h>
 #include <GA/GA_Types.h>
 #include <RE/RE_Geometry.h>
 #include <GT/GT_GEOPrimitive.h>
 #include <RE/RE_RenderContext.h>
 #include "UT_GSplatVectorTypes.h"
+#include "GSplatSorter.h"
+#include "GSplatCuller.h"
+#include "GSplatPixelUnpackRing.h"
+#include "GSplatStagingBuffer.h"
+#include "GSplatRegistry.h"
+#include "GSplatStore.h"
+#include "GSplatPacker.h"
+#include "GSplatChunker.h"
+#include "GSplatSlotAllocator.h"
+#include "GSplatQuantizer.h"
+#include "GSplatShCodebook.h"
+#include "GSplatTextureLayout.h"
+#include "GSplatPageCache.h"
+#include "GSplatPagedTexture.h"
+#include "GSplatPackCache.h"
+#include "GSplatShBaker.h"
+#include "GSplatMappedBuffer.h"
+
+#include <tbb/task_group.h>
+#include <atomic>
+#include <chrono>
+#include <map>
 
 class GSplatRenderer {
 
 private:
-    static const GA_Size GSPLAT_COUNT_MAX = 1 << 23; // 8,388,608 GSplats
+    static const GA_Size GSPLAT_COUNT_MAX = 1 << 26; // 67,108,864 GSplats
 
 public:
     static GSplatRenderer& getInstance() {
@@ -31,99 +54,358 @@ public:
         return instance;
     }
 
-    std::string registerUpdate(
+    // Id of the splats of the primitive starting at gVtxOffset, in that version of the detail.
+    // Also the key of their GSplatStore.
+    static std::string makeRegistryId(
+        const GU_Detail *gdp,
+        const RE_CacheVersion &gversion, 
+        const GA_Offset &gVtxOffset);
+
+    // Registers the splats of the primitive whose store was shared under registryId, see
+    // makeRegistryId. The handle stays the same for as long as the id does.
+    GSplatRegistry::Handle registerUpdate(
+        const std::string &registryId,
         const GU_Detail *gdp,
         const RE_CacheVersion &gversion, 
-        const GA_Offset &gVtxOffset,
-        const GA_Size &splatCount,
         const UT_Vector3 &splatOrigin,
-        const UT_Vector3Array& splatPts, 
-        const UT_Vector3HArray& splatColors,
-        const UT_FloatArray& splatAlphas,
-        const UT_Vector3HArray& splatScales,
-        const UT_Vector4HArray& splatOrients,
-        const MyUT_Matrix4HArray& splatShxs,
-        const MyUT_Matrix4HArray& splatShys,
-        const MyUT_Matrix4HArray& splatShzs); 
+        const GSplatStore::Handle &store,
+        const std::vector<float> &instanceTransforms); 
     
-    void includeInRenderPass(std::string  gSplatId);
-    void flushEntriesForMatchingDetail(std::string myRegistryId);
+    void includeInRenderPass(const GSplatRegistry::Handle registryHandle);
+    void flushEntriesForMatchingDetail(const GSplatRegistry::Handle registryHandle);
     void generateRenderGeometry(RE_RenderContext r);
-    void render(RE_RenderContext r, bool isObjectLevel);
+    // Draws the render set as seen from the viewport, an opaque key for the viewport being
+    // drawn. Every viewport keeps its own sorted order and only sorts again when its own
+    // camera moves, the atlas is shared by all of them.
+    void render(RE_RenderContext r, const void *viewport, bool isObjectLevel);
+    // Frees the sorted order and the textures of a viewport that went away
+    void releaseViewport(const void *viewport);
     void postRender();
     void setRenderingEnabled(bool isRenderEnabled);
     void setExplicitCameraPos(const UT_Vector3 explicitCameraPos);
     void setSphericalHarmonicsOrder(const int shOrder);
+    void setSortMode(const GSplatSorter::SortMode sortMode);
+    // Draws each splat as six vertices that all project it, instead of one point expanded by
+    // the geometry shader. Kept selectable until the two are measured against each other.
+    void setQuadVertices(const bool isQuadVertices);
+    void setCullingThresholds(const float minOpacity, const float minPixelRadius);
+    void setLodPixelError(const float lodPixelError);
+    void setCompactEncoding(const bool isCompactEncoding);
+    void setShCodebookSize(const int shCodebookSize);
+    void setGpuMemoryBudget(const int gpuMemoryBudget);
+    void setShBake(const bool isShBake);
 
-private:
-    struct GSplatRegisterEntry {
-        GU_Detail *gdp;
-        RE_CacheVersion gversion;
-        GA_Offset gvtx;
-        GA_Size splatCount = 0;
-        UT_Vector3 splatOrigin;
-        bool active = false;
-        int age = -1;
-        int ageSinceLastActive = -1;
-        UT_Vector3Array* splatPts = NULL;
-        UT_Vector3HArray* splatColors = NULL;
-        UT_FloatArray* splatAlphas = NULL;
-        UT_Vector3HArray* splatScales = NULL;
-        UT_Vector4HArray* splatOrients = NULL;
-        MyUT_Matrix4HArray* splatShxs = NULL;
-        MyUT_Matrix4HArray* splatShys = NULL;
-        MyUT_Matrix4HArray* splatShzs = NULL;
-    };
+    // True while a background sort of the viewport is running, the caller should keep
+    // redrawing so the new order gets picked up as soon as it is ready.
+    bool isSortInFlight(const void *viewport) const;
+    // True while pages of an out of core atlas that are in view still wait to be loaded
+    bool isStreaming() const { return myPageCache.hasPendingLoads() || !myPageLoads.empty(); }
 
+private:
     GSplatRenderer();
+    ~GSplatRenderer();
 
     GSplatRenderer(const GSplatRenderer&) = delete;
     GSplatRenderer& operator=(const GSplatRenderer&) = delete;
 
-    UT_Map<std::string, std::unique_ptr<GSplatRegisterEntry>> myRenderStateRegistry;
-    UT_Set<std::string> myActiveRegistries;
-
-    RE_Geometry *myTriangleGeo;
-    RE_Texture *myTexSortedIndex;
-    int myGSplatSortedIndexTexDim;
-    RE_Texture *myTexGsplatShDeg1And2;
-    RE_Texture *myTexGsplatShDeg3;
-    int myGSplatShDeg1And2TexDim;
-    int myGSplatShDeg3TexDim;
-    RE_Texture *myTexGsplatPosColorAlphaScaleOrient;
-    int myGSplatPosColorAlphaScaleOrientTexDim;
+    GSplatRegistry myRegistry;
+
+    RE_Geometry *mySplatPointGeo;
+    RE_Geometry *mySplatQuadGeo;
+    bool myIsQuadVertices;
+    GSplatTextureLayout myGSplatSortedIndexTexLayout; // of the sorted index texture of every view
+    // One texture per SH degree, see GSplatPacker::packSh
+    RE_Texture *myTexGsplatSh[GSplatPacker::SH_DEGREE_COUNT];
+    GSplatTextureLayout myGSplatShTexLayout[GSplatPacker::SH_DEGREE_COUNT];
+    RE_Texture *myTexGsplatPosColorAlphaCovariance;
+    GSplatTextureLayout myGSplatPosColorAlphaCovarianceTexLayout;
+    // Used instead of myTexGsplatPosColorAlphaCovariance with the compact encoding, see GSplatQuantizer
+    RE_Texture *myTexGsplatCompact;
+    GSplatTextureLayout myGSplatCompactTexLayout;
+    RE_Texture *myTexGsplatChunkBounds;
+    GSplatTextureLayout myGSplatChunkBoundsTexLayout;
+    // With an SH codebook the SH textures hold codebook entries, and this one the entry of each splat
+    RE_Texture *myTexGsplatShIndex;
+    GSplatTextureLayout myGSplatShIndexTexLayout;
     std::vector<UT_Vector3F> mySplatPoints;
+    std::vector<float> mySplatCullRadii;
+    std::vector<float> mySplatAlphas;
+    // Extent and parent extent per slot, see GSplatLodBuilder. Only looked at once an entry
+    // with a LOD hierarchy got packed, the others always pass.
+    std::vector<float> mySplatLodExtents;
+    bool myHasLodExtents;
+    std::vector<int> mySplatPackDestinations; // scratch, spatial (Morton) order of the entry being packed
+    std::vector<float> mySplatCompactScratch; // scratch, float texels of the entry being quantized
+    GSplatChunker myChunker;
+
+    // Persistent atlas: every entry of the render set owns a range of slots in the textures
+    // and in the arrays above, allocated in whole chunks. Unused slots have a negative opacity
+    // so culling always drops them. Adding or removing an entry only touches its own range,
+    // everything is repacked when the atlas runs out of room or gets too fragmented.
+    struct GSplatAtlasRange {
+        std::string registryKey; // of the entry, matched against the previous key of the next version
+        size_t begin = 0;
+        size_t count = 0; // splats, the range is padded to the next chunk
+        size_t shCodebookBegin = 0;
+        size_t shCodebookCount = 0; // entries of the SH codebook trained for this range
+        std::vector<float> shCodebook; // trained once the SH of the range are first uploaded
+        // The packing of the entry on disk, if GSPLAT_CACHE_DIR is set, see findPackCache
+        std::shared_ptr<const GSplatPackCache> packCache;
+        uint64_t packCacheHash = 0; // content hash of the store packCache was resolved for
+        // With instances, the opacities of the range, whose own slots are then culled
+        std::vector<float> sourceAlphas;
+        size_t instanceBegin = 0; // slot of the copy of the first instance, see rebuildInstances
+        size_t instanceCount = 0;
+    };
+    // Where packAtlasRange writes, each pointer already offset to the range. These point into
+    // the staging buffers below, mapped for the range or for the whole atlas.
+    struct GSplatAtlasRegion {
+        float *posColorAlphaCovariance = nullptr;
+        uint32_t *compact = nullptr;
+        float *chunkBounds = nullptr;
+    };
+
+    GSplatStagingBuffer myPosColorAlphaCovarianceStaging;
+    GSplatStagingBuffer myCompactStaging;
+    GSplatStagingBuffer myChunkBoundsStaging;
+    GSplatStagingBuffer myShStaging; // SH degrees and SH codebook indices, one at a time
+
+    // Every texture holding per splat data goes through one of these, see GSplatPagedTexture.
+    // The SH ones are only paged without a codebook, the codebook itself is small.
+    GSplatPagedTexture myPosColorAlphaCovariancePages;
+    GSplatPagedTexture myCompactPages;
+    GSplatPagedTexture myChunkBoundsPages;
+    GSplatPagedTexture myShIndexPages;
+    GSplatPagedTexture myShPages[GSplatPacker::SH_DEGREE_COUNT];
+    static constexpr size_t ATLAS_CAPACITY_MIN = 1 << 16;
+    static constexpr float ATLAS_FRAGMENTATION_RATIO_MAX = 0.5f;
+    GSplatSlotAllocator myAtlasAllocator{GSplatChunker::CHUNK_SIZE};
+    std::map<GSplatRegistry::Handle, GSplatAtlasRange> myAtlasRanges;
     UT_Vector3 mySplatOrigin;
 
-    int myGSplatCount;
+    // SH codebook entries are allocated the same way, every entry of the render set with SH
+    // data owns a codebook of up to myAtlasShCodebookSize entries. Entry 0 stays zeroed for
+    // the splats without SH.
+    static constexpr size_t SH_CODEBOOK_CAPACITY_MIN = 1 << 12;
+    GSplatSlotAllocator myShCodebookAllocator{1};
+
+    int myGSplatCount; // atlas high water mark
+    bool myIsCompactEncodingRequested;
+    bool myIsAtlasCompact;
+    int myShCodebookSizeRequested; // 0 for per splat SH
+    int myAtlasShCodebookSize;
+
+    // Out of core atlas: with a GPU memory budget too small for the whole atlas, the textures
+    // only have room for the pages the budget allows, and the pages in view are streamed into
+    // them, at most PAGE_STREAM_BYTES_PER_FRAME worth per frame. The sorted indices stay in
+    // atlas slots, the shader looks their page up in myTexPageTable. Culling only looks at the
+    // resident pages, the splats of the others have a negative opacity in mySplatResidentAlphas.
+    static constexpr size_t PAGE_STREAM_BYTES_PER_FRAME = size_t(64) << 20;
+    int myGpuMemoryBudgetRequested; // MB, 0 for no budget
+    int myAtlasGpuMemoryBudget;
+    GSplatPageCache myPageCache;
+    std::vector<float> myPageImportance;
+    std::vector<GSplatPageCache::Load> myPageLoads; // planned, not uploaded yet
+    std::vector<float> mySplatResidentAlphas;
+    RE_Texture *myTexPageTable;
+    GSplatTextureLayout myGSplatPageTableTexLayout;
+
+    // Instancing: an entry with instance transforms is packed once into its range like any
+    // other, but its own slots are culled and every instance gets a transformed copy of the
+    // culling inputs of the range, past the atlas capacity. The sorted indices of an instance
+    // point into those copies, the shader looks up the atlas slot they were copied from and
+    // the transform of the instance in myTexInstanceChunks and myTexInstanceTransforms. The
+    // texels, and so the GPU memory, only grow with the unique entries.
+    static constexpr int INSTANCE_TRANSFORM_TEXELS = 4; // RGBA32F, rows of the affine transform then padding
+    size_t myInstanceSlotCount; // past the atlas capacity, whole chunks per instance
+    std::vector<int> myInstanceChunks; // per chunk of the copies, the atlas slot it was copied from and its instance
+    std::vector<int> myInstancePages; // per chunk of the copies, the atlas page it was copied from
+    std::vector<float> myInstanceTransforms; // INSTANCE_TRANSFORM_TEXELS texels per instance
+    std::vector<UT_Matrix3F> myInstanceInverseLinears; // per instance, row vector inverse of its linear part, see bakeShColors
+    RE_Texture *myTexInstanceChunks;
+    GSplatTextureLayout myGSplatInstanceChunkTexLayout;
+    RE_Texture *myTexInstanceTransforms;
+    GSplatTextureLayout myGSplatInstanceTransformTexLayout;
 
     bool myIsRenderEnabled;
     bool myIsShDataPresent;
     bool myCanRender;
     bool myIsExplicitCameraPosSet;
     UT_Vector3 myExplicitCameraPos;
-    int myShOrder;
-
-    // Variables to hold camera sorting state
-    UT_Vector3F myPreviousCameraPos; 
-    float mySortDistanceAccum = 0.0;
-    bool myIsFreshGeometry;
-    std::vector<float> myGsplatZDistances;
-    std::vector<int> myGsplatZIndices;
-    
-    unsigned int closestSqrtPowerOf2(const int n);
+    int myShOrder; // highest order requested this frame
+
+    // SH degrees are only resident up to the highest order in use. Higher degrees get packed
+    // and uploaded once some detail asks for them, and released once nothing did for
+    // SH_RELEASE_SECONDS.
+    static constexpr double SH_RELEASE_SECONDS = 30.0;
+    int myShResidentOrder;
+    std::chrono::steady_clock::time_point myShLastRequested[GSplatPacker::SH_DEGREE_COUNT];
+
+    // SH bake: the view dependent colour is evaluated on the CPU along with every sort, see
+    // GSplatShBaker, and every view uploads it as one RGB16F texel per sorted splat. The resident
+    // SH degrees then live in host memory, in myShBakeCoefficients, instead of in the SH textures,
+    // which are neither allocated nor bound. Trades GPU memory and per frame SH fetches for host
+    // memory and CPU time per sort. No SH codebook while baking.
+    static constexpr int SH_BAKE_BLOCK_SIZE = 256;
+    bool myIsShBakeRequested;
+    bool myIsAtlasShBaked;
+    GSplatMappedBuffer myShBakeCoefficients[GSplatPacker::SH_DEGREE_COUNT]; // per atlas slot, see GSplatPacker::packSh
+
+    // Everything the culling and sorting of a frame depends on, captured on the draw thread
+    struct GSplatSortRequest {
+        UT_Vector3F cameraPos;
+        double viewProj[16] = {};
+        float pixelScale = 0.0f;
+        float minOpacity = GSplatCuller::DEFAULT_MIN_OPACITY;
+        float minPixelRadius = GSplatCuller::DEFAULT_MIN_PIXEL_RADIUS;
+        float lodPixelError = GSplatCuller::DEFAULT_LOD_PIXEL_ERROR;
+        GSplatSorter::SortMode sortMode = GSplatSorter::GSPLAT_SORT_COHERENT;
+        int shBakeOrder = 0; // SH order the sort bakes the colours of the view with, 0 for none
+    };
+
+    float myCullMinOpacity;
+    float myCullMinPixelRadius;
+    float myLodPixelError;
+    GSplatSorter::SortMode mySortMode;
+
+    // What follows the camera of one viewport. The sorted order lives in the view's own index
+    // texture, which the shader reads the atlas slots to draw from.
+    //
+    // Background sort: the job sorts from a camera snapshot into sortBackBuffer, seeded with
+    // the order currently on display (zIndices), and both get swapped once it completes.
+    // A job that is still running when the camera moves again gets cancelled and restarted,
+    // at most SORT_JOB_MAX_CONSECUTIVE_CANCELS times in a row so that some order always lands.
+    // The jobs of different views run side by side, each with its own scratch space.
+    static constexpr int SORT_JOB_MAX_CONSECUTIVE_CANCELS = 2;
+    struct GSplatViewState {
+        RE_Texture *texSortedIndex = nullptr; // mirrors zIndices
+        GSplatTextureLayout sortedIndexTexLayout;
+        RE_Texture *texShBaked = nullptr; // mirrors shBakedColors
+        GSplatTextureLayout shBakedTexLayout;
+
+        UT_Vector3F previousCameraPos = UT_Vector3F(0.0f, 0.0f, 0.0f);
+        GSplatSortRequest lastSortRequest;
+        float sortDistanceAccum = 0.0f;
+        bool isFreshGeometry = true;
+        std::vector<int> zIndices; // sized to the full texture
+        int visibleSplatCount = 0; // leading entries of zIndices that survived culling
+        // With the SH bake, what the SH add to the colour of the visible entries of zIndices, rgb halves
+        std::vector<uint16_t> shBakedColors;
+        int shBakedOrder = 0;
 
-    bool isRenderStateRegistryCurrent();
-    bool checkSignificantDelta(const UT_Vector3F& newPos, const UT_Vector3F& oldPos, const float threshold = 0.0f);
-    bool argsortByDistance(const UT_Vector3F *posSplatPointsData, const UT_Vector3F &ref_pos, const int pointCount);
+        // Once the texture holds a full copy, new orders only stream the entries in
+        // [indexDirtyBegin, indexDirtyEnd) through the unpack ring
+        GSplatPixelUnpackRing sortedIndexUploadRing;
+        bool indexNeedsFullUpload = true;
+        int indexDirtyBegin = 0;
+        int indexDirtyEnd = 0;
+
+        // Scratch space for sortVisibleSplats, only touched by one sort of the view at a time
+        GSplatSorter sorter;
+        GSplatCuller culler;
+        GSplatChunker::SortScratch chunkerScratch;
+        std::vector<int> visibleIndices;
+        std::vector<UT_Vector3F> visiblePoints;
+        std::vector<int> visibleSeed;
+        std::vector<int> visibleOrder;
+        std::vector<int> globalToVisible;
+
+        tbb::task_group sortTaskGroup;
+        std::atomic<bool> sortJobCancel{false};
+        std::atomic<bool> sortJobDone{false};
+        bool sortJobSucceeded = false;
+        bool sortJobRunning = false;
+        int sortJobConsecutiveCancels = 0;
+        bool sortPending = false;
+        std::vector<int> sortBackBuffer;
+        int sortBackVisibleCount = 0;
+        int sortBackDirtyBegin = 0;
+        int sortBackDirtyEnd = 0;
+        std::vector<uint16_t> shBakedBackBuffer;
+    };
+    std::map<const void*, std::unique_ptr<GSplatViewState>> myViews;
+
+    GSplatViewState &getViewState(const void *viewport);
+    bool isAnySortRunning() const;
+
+    bool checkSignificantDelta(GSplatViewState &view, const UT_Vector3F& newPos, const UT_Vector3F& oldPos, const float threshold = 0.0f);
+    bool argsortByDistance(GSplatViewState &view, const UT_Vector3F *posSplatPointsData, const GSplatSortRequest &request, const int pointCount);
+    int sortVisibleSplats(
+        GSplatViewState &view,
+        const UT_Vector3F *posSplatPointsData, 
+        const int pointCount,
+        const GSplatSortRequest &request,
+        const int *previousOrder,
+        const int previousCount,
+        int *outIndices,
+        const std::atomic<bool> *cancelRequested);
+    void launchAsyncSort(GSplatViewState &view, const UT_Vector3F *posSplatPointsData, const GSplatSortRequest &request, const int pointCount);
+    bool collectAsyncSort(GSplatViewState &view);
+    void uploadSortedIndices(RE_RenderContext r, GSplatViewState &view);
+    void bakeShColors(const GSplatSortRequest &request, const int *sortedIndices, const int count, std::vector<uint16_t> &colors) const;
+    void uploadShBakedColors(RE_RenderContext r, GSplatViewState &view);
+    // Entries of newOrder, newCount long, that differ from what the texture holds for previousOrder, previousCount long
+    static void findChangedRange(const int *previousOrder, const int previousCount, const int *newOrder, const int newCount, int &begin, int &end);
+    void cancelAsyncSort(GSplatViewState &view);
+    void cancelAsyncSorts();
 
     void freeTextureResources();
     void initialiseTextureResources();
 
     void initialiseTextureResourceCommon(RE_Texture* tex);
     void setTextureFilteringCommon(RE_RenderContext r, RE_Texture* tex);
+    void setTextureLayout(RE_Texture* tex, const GSplatTextureLayout &layout);
 
     void allocateTextureResources(RE_RenderContext r);
+    void configurePagedTextures();
+    size_t computeBytesPerPage() const;
+
+    bool planPageLoads(const GSplatSortRequest &request);
+    void uploadPageLoads(RE_RenderContext r);
+    void refreshResidentAlphas(const size_t slotBegin, const size_t slotEnd);
+    void copyResidentAlphas(const size_t slotBegin, const size_t slotEnd, const size_t copyOffset);
+    const float *getCullAlphas() const;
+
+    void rebuildAtlas(RE_RenderContext r, const std::vector<GSplatRegistry::Handle> &renderSet);
+    void packAtlasRange(
+        const GSplatRegistry::Entry &entry, 
+        GSplatAtlasRange &range, 
+        const GSplatAtlasRegion &region);
+    void packSplats(
+        const GSplatRegistry::Entry &entry, 
+        const size_t count, 
+        const float origin[3], 
+        const GSplatPackTarget &target, 
+        const GSplatAtlasRegion &region);
+    const GSplatPackCache *findPackCache(
+        const GSplatRegistry::Entry &entry, 
+        GSplatAtlasRange &range);
+    std::shared_ptr<const GSplatPackCache> writePackCache(
+        const GSplatRegistry::Entry &entry, 
+        const std::string &path);
+    void copyPackCache(
+        const GSplatPackCache &cache, 
+        const GSplatAtlasRange &range, 
+        const GSplatAtlasRegion &region);
+    void uploadAtlasRange(
+        RE_RenderContext r, 
+        const GSplatRegistry::Entry &entry, 
+        GSplatAtlasRange &range);
+    void refreshAtlasRange(
+        RE_RenderContext r, 
+        const GSplatRegistry::Entry &entry, 
+        GSplatAtlasRange &range);
+    void releaseAtlasRange(const GSplatAtlasRange &range);
+    bool rebuildInstances();
+    void uploadInstances(RE_RenderContext r);
+    void updateShResidency(RE_RenderContext r);
+    void releaseShDegrees(const int keptOrder);
+    void uploadAtlasRangeSh(
+        RE_RenderContext r, 
+        const GSplatRegistry::Entry &entry, 
+        GSplatAtlasRange &range, 
+        const int firstDegree, 
+        const int lastDegree);
 
     // A cheap way to avoid spamming teminal when warning about OBJ level rendering
     bool _justPrintedOBJLevelRenderingWarning = false;
@@ -0,0 +1,48 @@
+/***************************************************************************************/
+/*  Filename: GSplatShBaker.h                                                          */
+/*  Description: HDK independent CPU evaluation of view dependent SH colour            */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_SH_BAKER__
+#define __GSPLAT_SH_BAKER__
+
+#include "GSplatPacker.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+// ShadeSH of GSplatSphericalHarmonicsLib on the CPU, GSplatFloat4::LANE_COUNT splats at a time.
+// With the SH bake the view dependent colour of the splats of a view is evaluated once per
+// sort rather than once per splat and frame by the vertex shader, which then neither needs
+// the SH textures nor fetches them.
+//
+// Only the part the SH degrees add to the base colour is baked. The shader adds it to the
+// colour it fetches anyway and clamps the sum as ShadeSH does.
+class GSplatShBaker
+{
+public:
+    // The SH coefficients of the degrees from 1 to order, per slot in the layout of GSplatPacker::packSh
+    struct Coefficients
+    {
+        const uint16_t *degrees[GSplatPacker::SH_DEGREE_COUNT] = {};
+        int order = 0;
+    };
+
+    // Bakes count splats. slots holds the slot of the coefficients of every splat, toPoints the
+    // vector from the camera to it, xyz, in the frame its SH are defined in. Writes rgb halves.
+    static void bake(
+        const Coefficients &coefficients,
+        const int *slots,
+        const float *toPoints,
+        const size_t count,
+        uint16_t *residuals);
+};
+
+
+#endif // __GSPLAT_SH_BAKER__
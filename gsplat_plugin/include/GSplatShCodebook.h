@@ -0,0 +1,77 @@
+/***************************************************************************************/
+/*  Filename: GSplatShCodebook.h                                                       */
+/*  Description: Vector quantization of spherical harmonics for the GSplat Plugin      */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_SH_CODEBOOK__
+#define __GSPLAT_SH_CODEBOOK__
+
+#include "GSplatPacker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Clusters the SH coefficients of splats with k-means, so that each splat only needs the
+// index of its palette entry in the codebook instead of its own 45 coefficients.
+// Training runs on an evenly spaced subset of the splats, all of them are assigned afterwards.
+class GSplatShCodebook
+{
+public:
+    static constexpr int VECTOR_SIZE = 3 * GSplatPacker::SH_COEFFICIENT_COUNT; // 15 rgb coefficients
+    static constexpr int ENTRY_COUNT_MIN = 16;
+    static constexpr int ENTRY_COUNT_MAX = 1 << 16;
+
+    struct Result {
+        std::vector<float> codebook; // VECTOR_SIZE floats per entry, coefficient major (rgb, rgb, ...)
+        std::vector<int> indices;    // per splat, in source order
+        double rmse = 0.0;           // per coefficient, over all splats
+    };
+
+    // Builds a codebook of at most size entries (never more than there are splats) for the
+    // first count splats of source, which must have SH data. Deterministic for given inputs.
+    static void build(const GSplatSourceView &source, const size_t count, const int size, Result &result);
+
+    // Writes the coefficients of one SH degree of the codebook entries, in the texel layout
+    // GSplatPacker::packSh uses for splats.
+    static void packCodebook(const std::vector<float> &codebook, const int degree, uint16_t *out);
+
+    // Codebook entries sorted by their projection on a unit axis, the principal axis of the data
+    // in build. The projections of two vectors are never further apart than the vectors
+    // themselves, so the search walks outwards from the query's projection and stops once that
+    // gap alone is larger than the best distance found.
+    class NearestEntrySearch
+    {
+    public:
+        NearestEntrySearch(const float *codebook, const int entryCount, const float *axis);
+
+        // Index of the closest entry, its squared distance in outDistance. hint, if not negative,
+        // is a likely candidate to start from.
+        int find(const float *v, const int hint, float &outDistance) const;
+
+    private:
+        float project(const float *v) const;
+
+        const float *myCodebook;
+        int myEntryCount;
+        float myAxis[VECTOR_SIZE];
+        std::vector<float> myProjections;
+        std::vector<int> myEntries;
+        std::vector<float> mySorted;
+    };
+
+private:
+    static constexpr int ITERATION_COUNT = 8;
+    static constexpr size_t TRAINING_SAMPLES_PER_ENTRY = 16;
+    static constexpr size_t TRAINING_SAMPLES_MIN = 1 << 15;
+    static constexpr size_t TRAINING_SAMPLES_MAX = 1 << 16;
+};
+
+
+#endif // __GSPLAT_SH_CODEBOOK__
@@ -32,6 +32,7 @@ public:
     enum GSplatShaderType {
         GSPLAT_WIRE_SHADER,
         GSPLAT_MAIN_SHADER,
+        GSPLAT_MAIN_QUAD_SHADER,
     };
     
     GsplatShaderManager();
@@ -52,8 +53,9 @@ public:
 private:
     std::unordered_map<GSplatShaderType, RE_Shader*> myShaderMap;
     
-    bool getSourceForShaderType(const GSplatShaderType shaderType, char **vertexShaderSource, char **fragmentShaderSource);
-    bool addAndLinkShader(RE_Shader* shader, RE_Render* r, const char* customVertexSource, const char* customFragmentSource, UT_String& msg);
+    // The geometry shader source is null for the shaders without one
+    bool getSourceForShaderType(const GSplatShaderType shaderType, char **vertexShaderSource, char **geometryShaderSource, char **fragmentShaderSource);
+    bool addAndLinkShader(RE_Shader* shader, RE_Render* r, const char* customVertexSource, const char* customGeometrySource, const char* customFragmentSource, UT_String& msg);
     std::string getNameForShaderType(GSplatShaderType shaderType);
 };
 
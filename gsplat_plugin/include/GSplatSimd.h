@@ -0,0 +1,149 @@
+/***************************************************************************************/
+/*  Filename: GSplatSimd.h                                                             */
+/*  Description: HDK independent four wide float vectors for the CPU kernels           */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_SIMD__
+#define __GSPLAT_SIMD__
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// GSPLAT_NO_SIMD forces the plain loops, to test them on hardware that has SIMD
+#if defined(GSPLAT_NO_SIMD)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GSPLAT_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define GSPLAT_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+
+// Four floats processed together, SSE2 on x86-64, NEON on arm64 and plain loops elsewhere.
+// Written out by hand because compilers keep loops with float compares and selects scalar
+// unless told floating point exceptions do not matter, which the build does not say.
+//
+// Compares return masks, all bits set in the lanes where they hold, to be combined with &.
+struct GSplatFloat4
+{
+    static constexpr int LANE_COUNT = 4;
+
+#if defined(GSPLAT_SIMD_SSE2)
+    __m128 v;
+
+    static GSplatFloat4 load(const float *p) { return { _mm_loadu_ps(p) }; }
+    static GSplatFloat4 broadcast(const float f) { return { _mm_set1_ps(f) }; }
+    void store(float *p) const { _mm_storeu_ps(p, v); }
+
+    GSplatFloat4 operator+(const GSplatFloat4 &b) const { return { _mm_add_ps(v, b.v) }; }
+    GSplatFloat4 operator-(const GSplatFloat4 &b) const { return { _mm_sub_ps(v, b.v) }; }
+    GSplatFloat4 operator*(const GSplatFloat4 &b) const { return { _mm_mul_ps(v, b.v) }; }
+    GSplatFloat4 operator/(const GSplatFloat4 &b) const { return { _mm_div_ps(v, b.v) }; }
+    GSplatFloat4 operator&(const GSplatFloat4 &b) const { return { _mm_and_ps(v, b.v) }; }
+
+    friend GSplatFloat4 sqrt(const GSplatFloat4 &a) { return { _mm_sqrt_ps(a.v) }; }
+    friend GSplatFloat4 min(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { _mm_min_ps(a.v, b.v) }; }
+    friend GSplatFloat4 max(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { _mm_max_ps(a.v, b.v) }; }
+    friend GSplatFloat4 abs(const GSplatFloat4 &a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+    friend GSplatFloat4 lessEqual(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { _mm_cmple_ps(a.v, b.v) }; }
+    friend GSplatFloat4 greaterEqual(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+
+    // Truncated towards zero, and back to float
+    friend GSplatFloat4 truncate(const GSplatFloat4 &a) { return { _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v)) }; }
+    // 2^a for integral a within the float exponent range
+    friend GSplatFloat4 exp2Integral(const GSplatFloat4 &a)
+    {
+        return { _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(a.v), _mm_set1_epi32(127)), 23)) };
+    }
+#elif defined(GSPLAT_SIMD_NEON)
+    float32x4_t v;
+
+    static GSplatFloat4 load(const float *p) { return { vld1q_f32(p) }; }
+    static GSplatFloat4 broadcast(const float f) { return { vdupq_n_f32(f) }; }
+    void store(float *p) const { vst1q_f32(p, v); }
+
+    GSplatFloat4 operator+(const GSplatFloat4 &b) const { return { vaddq_f32(v, b.v) }; }
+    GSplatFloat4 operator-(const GSplatFloat4 &b) const { return { vsubq_f32(v, b.v) }; }
+    GSplatFloat4 operator*(const GSplatFloat4 &b) const { return { vmulq_f32(v, b.v) }; }
+    GSplatFloat4 operator/(const GSplatFloat4 &b) const { return { vdivq_f32(v, b.v) }; }
+    GSplatFloat4 operator&(const GSplatFloat4 &b) const
+    {
+        return { vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(b.v))) };
+    }
+
+    friend GSplatFloat4 sqrt(const GSplatFloat4 &a) { return { vsqrtq_f32(a.v) }; }
+    friend GSplatFloat4 min(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { vminq_f32(a.v, b.v) }; }
+    friend GSplatFloat4 max(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { vmaxq_f32(a.v, b.v) }; }
+    friend GSplatFloat4 abs(const GSplatFloat4 &a) { return { vabsq_f32(a.v) }; }
+    friend GSplatFloat4 lessEqual(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { vreinterpretq_f32_u32(vcleq_f32(a.v, b.v)) }; }
+    friend GSplatFloat4 greaterEqual(const GSplatFloat4 &a, const GSplatFloat4 &b) { return { vreinterpretq_f32_u32(vcgeq_f32(a.v, b.v)) }; }
+
+    friend GSplatFloat4 truncate(const GSplatFloat4 &a) { return { vcvtq_f32_s32(vcvtq_s32_f32(a.v)) }; }
+    friend GSplatFloat4 exp2Integral(const GSplatFloat4 &a)
+    {
+        return { vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(a.v), vdupq_n_s32(127)), 23)) };
+    }
+#else
+    float v[LANE_COUNT];
+
+    static GSplatFloat4 load(const float *p) { GSplatFloat4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    static GSplatFloat4 broadcast(const float f) { return { { f, f, f, f } }; }
+    void store(float *p) const { std::memcpy(p, v, sizeof(v)); }
+
+    template <typename F>
+    static GSplatFloat4 map(const F &f)
+    {
+        GSplatFloat4 r;
+        for (int i = 0; i < LANE_COUNT; ++i)
+        {
+            r.v[i] = f(i);
+        }
+        return r;
+    }
+
+    static float fromBits(const uint32_t bits) { float f; std::memcpy(&f, &bits, sizeof(f)); return f; }
+    static uint32_t toBits(const float f) { uint32_t bits; std::memcpy(&bits, &f, sizeof(bits)); return bits; }
+
+    GSplatFloat4 operator+(const GSplatFloat4 &b) const { return map([&](const int i) { return v[i] + b.v[i]; }); }
+    GSplatFloat4 operator-(const GSplatFloat4 &b) const { return map([&](const int i) { return v[i] - b.v[i]; }); }
+    GSplatFloat4 operator*(const GSplatFloat4 &b) const { return map([&](const int i) { return v[i] * b.v[i]; }); }
+    GSplatFloat4 operator/(const GSplatFloat4 &b) const { return map([&](const int i) { return v[i] / b.v[i]; }); }
+    GSplatFloat4 operator&(const GSplatFloat4 &b) const { return map([&](const int i) { return fromBits(toBits(v[i]) & toBits(b.v[i])); }); }
+
+    friend GSplatFloat4 sqrt(const GSplatFloat4 &a) { return map([&](const int i) { return std::sqrt(a.v[i]); }); }
+    friend GSplatFloat4 min(const GSplatFloat4 &a, const GSplatFloat4 &b) { return map([&](const int i) { return a.v[i] < b.v[i] ? a.v[i] : b.v[i]; }); }
+    friend GSplatFloat4 max(const GSplatFloat4 &a, const GSplatFloat4 &b) { return map([&](const int i) { return a.v[i] > b.v[i] ? a.v[i] : b.v[i]; }); }
+    friend GSplatFloat4 abs(const GSplatFloat4 &a) { return map([&](const int i) { return fromBits(toBits(a.v[i]) & 0x7FFFFFFFu); }); }
+    friend GSplatFloat4 lessEqual(const GSplatFloat4 &a, const GSplatFloat4 &b) { return map([&](const int i) { return fromBits(a.v[i] <= b.v[i] ? ~0u : 0u); }); }
+    friend GSplatFloat4 greaterEqual(const GSplatFloat4 &a, const GSplatFloat4 &b) { return map([&](const int i) { return fromBits(a.v[i] >= b.v[i] ? ~0u : 0u); }); }
+
+    friend GSplatFloat4 truncate(const GSplatFloat4 &a) { return map([&](const int i) { return float(int32_t(a.v[i])); }); }
+    friend GSplatFloat4 exp2Integral(const GSplatFloat4 &a) { return map([&](const int i) { return fromBits(uint32_t(int32_t(a.v[i]) + 127) << 23); }); }
+#endif
+
+    // e^a for a in [-80, 0], within a few ulp of std::exp
+    friend GSplatFloat4 expNegative(const GSplatFloat4 &a)
+    {
+        const GSplatFloat4 t = max(a, broadcast(-80.0f)) * broadcast(1.44269504f);
+        // t <= 0, so truncating t - 0.5 rounds to the nearest integer
+        const GSplatFloat4 whole = truncate(t - broadcast(0.5f));
+        const GSplatFloat4 f = t - whole;
+        GSplatFloat4 p = broadcast(0.00133335581f);
+        p = p * f + broadcast(0.00961812911f);
+        p = p * f + broadcast(0.0555041087f);
+        p = p * f + broadcast(0.240226507f);
+        p = p * f + broadcast(0.693147181f);
+        p = p * f + broadcast(1.0f);
+        return p * exp2Integral(whole);
+    }
+};
+
+
+#endif // __GSPLAT_SIMD__
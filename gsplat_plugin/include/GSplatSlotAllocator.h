@@ -0,0 +1,56 @@
+/***************************************************************************************/
+/*  Filename: GSplatSlotAllocator.h                                                    */
+/*  Description: Free list allocator of splat slot ranges in the GSplat texture atlas  */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_SLOT_ALLOCATOR__
+#define __GSPLAT_SLOT_ALLOCATOR__
+
+#include <cstddef>
+#include <map>
+
+
+// Hands out ranges of slots in [0, capacity), first fit from a free list that coalesces
+// neighbouring ranges on release. Range sizes are rounded up to the alignment, so ranges
+// also start on aligned slots.
+class GSplatSlotAllocator
+{
+public:
+    explicit GSplatSlotAllocator(const size_t alignment = 1);
+
+    // Forgets every range and sets the number of slots available.
+    void reset(const size_t capacity);
+
+    // Finds room for count slots and writes the first one into outBegin. Returns false,
+    // leaving everything untouched, if no free range nor the space left is large enough.
+    bool allocate(const size_t count, size_t &outBegin);
+
+    // Gives back a range returned by allocate, count being the same as when allocated.
+    void release(const size_t begin, const size_t count);
+
+    // Slots that allocate would actually reserve for count.
+    size_t getAlignedCount(const size_t count) const { return (count + myAlignment - 1) / myAlignment * myAlignment; }
+
+    size_t getCapacity() const { return myCapacity; }
+
+    // One past the last slot in use, everything above is free.
+    size_t getHighWaterMark() const { return myHighWaterMark; }
+
+    // Free slots below the high water mark.
+    size_t getFragmentedCount() const { return myFragmentedCount; }
+
+private:
+    size_t myAlignment;
+    size_t myCapacity;
+    size_t myHighWaterMark;
+    size_t myFragmentedCount;
+    std::map<size_t, size_t> myFreeRanges; // begin -> count, below the high water mark only
+};
+
+
+#endif // __GSPLAT_SLOT_ALLOCATOR__
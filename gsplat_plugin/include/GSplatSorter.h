@@ -0,0 +1,92 @@
+/***************************************************************************************/
+/*  Filename: GSplatSorter.h                                                           */
+/*  Description: Depth sorting engines for the GSplat Plugin                           */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_SORTER__
+#define __GSPLAT_SORTER__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+class GSplatSorter
+{
+public:
+    enum SortMode {
+        GSPLAT_SORT_RADIX = 0,      // LSD radix sort on the full 32-bit squared distance
+        GSPLAT_SORT_RADIX_16BIT,    // LSD radix sort on distance quantised to 16 bits (half the passes)
+        GSPLAT_SORT_COMPARATOR,     // tbb::parallel_sort with an indirect comparator (legacy path)
+        GSPLAT_SORT_COHERENT,       // repairs the previous order, falls back to GSPLAT_SORT_RADIX when too disordered
+        GSPLAT_SORT_CHUNKED,        // per chunk culling and ordering (GSplatChunker), sorted here as GSPLAT_SORT_RADIX
+        GSPLAT_SORT_MODE_COUNT
+    };
+
+    GSplatSorter();
+
+    // Writes into outIndices the permutation of [0, pointCount) that orders the points
+    // front to back as seen from cameraPos. positions holds pointCount xyz triplets.
+    // outIndices must have room for at least pointCount entries.
+    // previousOrder is an optional permutation from an earlier sort of the same points, used
+    // as the starting point by GSPLAT_SORT_COHERENT. It may alias outIndices.
+    // When cancelRequested is given and gets raised while sorting, the sort stops early and
+    // returns false, leaving outIndices in an unspecified state.
+    bool argsortByDistance(
+        const float *positions,
+        const size_t pointCount,
+        const float *cameraPos,
+        const SortMode mode,
+        int *outIndices,
+        const int *previousOrder = nullptr,
+        const std::atomic<bool> *cancelRequested = nullptr);
+
+    // Whether the last GSPLAT_SORT_COHERENT sort repaired the previous order (true)
+    // or had to fall back to a full sort (false).
+    bool wasLastSortIncremental() const { return myLastSortWasIncremental; }
+
+    static const char* getSortModeName(const SortMode mode);
+
+private:
+    static constexpr int RADIX_DIGIT_BITS = 8;
+    static constexpr int RADIX_BUCKET_COUNT = 1 << RADIX_DIGIT_BITS;
+    static constexpr size_t RADIX_MIN_BLOCK_SIZE = 1 << 15;
+    static constexpr size_t RADIX_MAX_BLOCK_COUNT = 256;
+
+    // Coherent sort: the previous order is repaired by a bounded insertion sort over cache
+    // sized blocks. Blocks that run out of budget count as disordered; past the ratio below,
+    // or after too many repairs in a row, a full sort is done instead.
+    static constexpr size_t COHERENT_BLOCK_SIZE = 1 << 12;
+    static constexpr size_t COHERENT_MOVES_PER_ELEMENT = 16;
+    static constexpr float COHERENT_MAX_DISORDER_RATIO = 0.1f;
+    static constexpr int COHERENT_MAX_CONSECUTIVE_REPAIRS = 30;
+
+    static uint32_t floatToSortableKey(const float value);
+
+    bool isCancelRequested() const { return myCancelRequested && myCancelRequested->load(std::memory_order_relaxed); }
+
+    void computeSquaredDistanceKeys(const float *positions, const size_t pointCount, const float *cameraPos);
+    void computeQuantisedDistanceKeys(const float *positions, const size_t pointCount, const float *cameraPos);
+    void radixSortKeys(const size_t count, const int passCount, int *outIndices);
+    void comparatorSort(const float *positions, const size_t pointCount, const float *cameraPos, int *outIndices);
+    bool coherentSort(const size_t pointCount, const int *previousOrder, int *outIndices);
+
+    std::vector<uint32_t> myKeys;
+    std::vector<uint32_t> myKeysAlt;
+    std::vector<int> myIndicesAlt;
+    std::vector<float> myDistances;
+    std::vector<size_t> myBlockHistograms;
+    std::vector<uint64_t> myKeyIndexPairs;
+    bool myLastSortWasIncremental;
+    int myConsecutiveRepairs;
+    const std::atomic<bool> *myCancelRequested;
+};
+
+
+#endif // __GSPLAT_SORTER__
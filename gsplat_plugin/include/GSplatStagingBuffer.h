@@ -0,0 +1,82 @@
+/***************************************************************************************/
+/*  Filename: GSplatStagingBuffer.h                                                    */
+/*  Description: Mapped pixel unpack buffer to pack texture uploads into               */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_STAGING_BUFFER__
+#define __GSPLAT_STAGING_BUFFER__
+
+#include <RE/RE_RenderContext.h>
+#include <RE/RE_Texture.h>
+#include <RE/RE_OGLBuffer.h>
+
+#include "GSplatTextureLayout.h"
+
+#include <cstddef>
+#include <vector>
+
+
+// Lends out memory for a range of texels of a texture, to be packed into in place and then
+// committed to the texture. The memory is a mapped pixel unpack buffer, so the texels go
+// from the packer to the driver without an intermediate copy in client memory. When no
+// buffer can be mapped it is client memory instead, still reused from one upload to the next.
+class GSplatStagingBuffer
+{
+public:
+    GSplatStagingBuffer();
+    ~GSplatStagingBuffer();
+
+    GSplatStagingBuffer(const GSplatStagingBuffer&) = delete;
+    GSplatStagingBuffer& operator=(const GSplatStagingBuffer&) = delete;
+
+    // Memory for texels [texelBegin, texelEnd) of tex, a texture array laid out as layout with
+    // texels of texelSize bytes, valid until commit. Its content is undefined.
+    void *map(
+        RE_RenderContext r,
+        RE_Texture *tex,
+        const GSplatTextureLayout &layout,
+        const size_t texelSize,
+        const size_t texelBegin,
+        const size_t texelEnd);
+
+    // Copies the texels written since map into the texture, which must already have storage.
+    void commit(RE_RenderContext r);
+
+    void free();
+
+    // Copies texels [texelBegin, texelEnd) from data, rectangle by rectangle as split by the
+    // layout. With a pixel unpack buffer bound data is an offset into it.
+    static void uploadTexelRange(
+        RE_RenderContext r,
+        RE_Texture *tex,
+        const GSplatTextureLayout &layout,
+        const void *data,
+        const size_t texelSize,
+        const size_t texelBegin,
+        const size_t texelEnd);
+
+private:
+    // Larger buffers are only held for the upload that needed them
+    static constexpr size_t KEPT_CAPACITY_MAX = size_t(32) << 20; // bytes
+
+    bool ensureCapacity(RE_RenderContext r, const size_t byteCount);
+
+    RE_OGLBuffer *myBuffer;
+    size_t myCapacity; // bytes
+    std::vector<char> myFallback;
+
+    RE_Texture *myTex;
+    GSplatTextureLayout myLayout;
+    size_t myTexelSize;
+    size_t myTexelBegin;
+    size_t myTexelEnd;
+    bool myIsBufferMapped;
+};
+
+
+#endif // __GSPLAT_STAGING_BUFFER__
@@ -0,0 +1,137 @@
+/***************************************************************************************/
+/*  Filename: GSplatStore.h                                                            */
+/*  Description: HDK independent shared storage of the splat data of a detail version  */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_STORE__
+#define __GSPLAT_STORE__
+
+#include "GSplatMappedBuffer.h"
+#include "GSplatPacker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// The per splat arrays of one primitive of one detail version, in the layout GSplatSourceView
+// describes. A store is filled once, by whoever first asks for it, and then shared read only
+// between the GR primitives drawing that version and the registry entries packed from it.
+// It is freed along with the last reference, so views taken from it stay valid for as long
+// as the reference they were taken from is held.
+//
+// The store of a new version can be derived from the previous one, then only the attributes
+// that changed get new arrays and the others are shared. Which ones changed is decided from
+// the source ids recorded with each store, the data ids of the attributes they were read from.
+//
+// The arrays are GSplatMappedArrays, so with GSPLAT_PAGING_DIR set they live in scratch files
+// rather than in RAM.
+class GSplatStore
+{
+public:
+    typedef std::shared_ptr<const GSplatStore> Handle;
+    typedef std::vector<int64_t> SourceIds;
+
+    enum Attribute
+    {
+        POSITIONS = 1 << 0,
+        COLORS = 1 << 1,
+        ALPHAS = 1 << 2,
+        SCALES = 1 << 3,
+        ORIENTS = 1 << 4,
+        SH = 1 << 5,
+        LOD_EXTENTS = 1 << 6,
+        ALL_ATTRIBUTES = (1 << 7) - 1
+    };
+    static constexpr int ATTRIBUTE_COUNT = 7;
+    // Source ids of what decides which point feeds which splat, any change invalidates every attribute
+    static constexpr int LAYOUT_SOURCE = ATTRIBUTE_COUNT;
+    static constexpr int SOURCE_COUNT = ATTRIBUTE_COUNT + 1;
+
+    // The store last shared under key, if something still holds it.
+    static Handle find(const std::string &key);
+
+    // A new store for count splats, with room for SH data and LOD extents if asked. The arrays
+    // are left for the caller to fill in before sharing it.
+    static std::shared_ptr<GSplatStore> create(const size_t count, const bool hasSh, const bool hasLodExtents);
+
+    // A new store for the next version of previous, which was shared under previousKey. The
+    // arrays of the attributes not in changedAttributes are shared with previous, the others
+    // are left for the caller to fill in. The splat count stays the same.
+    static std::shared_ptr<GSplatStore> createFrom(
+        const Handle &previous,
+        const std::string &previousKey,
+        const unsigned changedAttributes,
+        const bool hasSh,
+        const bool hasLodExtents);
+
+    // Makes a filled in store the one find returns for key.
+    static Handle share(const std::string &key, const std::shared_ptr<GSplatStore> &store);
+
+    size_t getCount() const { return myCount; }
+    bool hasSh() const { return !myShx->empty(); }
+    bool hasLodExtents() const { return !myLodExtents->empty(); }
+
+    GSplatSourceView getView() const;
+
+    // Key of the store this one was derived from, empty if it was created from scratch
+    const std::string &getPreviousKey() const { return myPreviousKey; }
+    // Attributes that differ from the store this one was derived from, all when created from scratch
+    unsigned getChangedAttributes() const { return myChangedAttributes; }
+
+    void setSourceIds(const int source, const SourceIds &ids) { mySourceIds[source] = ids; }
+    // Attributes read from sources with other ids than the recorded ones. A negative id stands
+    // for an unknown source, never equal to anything.
+    unsigned findChangedAttributes(const SourceIds ids[SOURCE_COUNT]) const;
+
+    // Hash of the content, see GSplatPackCache::computeContentHash. 0 when it was not computed.
+    void setContentHash(const uint64_t contentHash) { myContentHash = contentHash; }
+    uint64_t getContentHash() const { return myContentHash; }
+
+    float *getPositions() { return myPositions->data(); }
+    uint16_t *getColors() { return myColors->data(); }
+    float *getAlphas() { return myAlphas->data(); }
+    uint16_t *getScales() { return myScales->data(); }
+    uint16_t *getOrients() { return myOrients->data(); }
+    uint16_t *getShx() { return myShx->data(); }
+    uint16_t *getShy() { return myShy->data(); }
+    uint16_t *getShz() { return myShz->data(); }
+    float *getLodExtents() { return myLodExtents->data(); }
+
+    // Halves per splat and channel of the SH arrays, see GSplatSourceView
+    static constexpr int SH_HALVES_PER_CHANNEL = 16;
+
+private:
+    template <typename T>
+    using Array = std::shared_ptr<GSplatMappedArray<T>>;
+
+    GSplatStore() = default;
+
+    void allocate(const unsigned attributes, const bool hasSh, const bool hasLodExtents);
+
+    size_t myCount = 0;
+    Array<float> myPositions;
+    Array<uint16_t> myColors;
+    Array<float> myAlphas;
+    Array<uint16_t> myScales;
+    Array<uint16_t> myOrients;
+    Array<uint16_t> myShx;
+    Array<uint16_t> myShy;
+    Array<uint16_t> myShz;
+    Array<float> myLodExtents;
+
+    std::string myPreviousKey;
+    unsigned myChangedAttributes = ALL_ATTRIBUTES;
+    SourceIds mySourceIds[SOURCE_COUNT];
+    uint64_t myContentHash = 0;
+};
+
+
+#endif // __GSPLAT_STORE__
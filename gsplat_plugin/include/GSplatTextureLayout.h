@@ -0,0 +1,88 @@
+/***************************************************************************************/
+/*  Filename: GSplatTextureLayout.h                                                    */
+/*  Description: Texel layout of the GSplat textures, rows within array layers         */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_TEXTURE_LAYOUT__
+#define __GSPLAT_TEXTURE_LAYOUT__
+
+#include <algorithm>
+#include <cstddef>
+
+
+// Where the texels of a GSplat texture live. Every texture is a 2D array of layers of a fixed
+// width, filled along a row, then down the rows of a layer, then on to the next layer. Rows
+// are tight: only the rows past the last texel in use are wasted, not up to three quarters of
+// a square power of two texture, and the size is bound by the layer count rather than by the
+// largest 2D texture. The width is a power of two and a multiple of the texels per element of
+// every texture, so the texels of an element never straddle two rows.
+//
+// Texel indices are 64 bit here. The shader derives coordinates from element indices instead,
+// without ever multiplying them out into texel indices, see computeTextureCoordinates.
+class GSplatTextureLayout
+{
+public:
+    static constexpr int WIDTH = 1 << 12;
+    // Rows per layer at most, the layers of a texture are as tall as needed and no taller
+    static constexpr int LAYER_HEIGHT_MAX = 1 << 12;
+
+    // Texels of one layer, whole rows or part of a single row
+    struct Rect
+    {
+        int x;
+        int y;
+        int layer;
+        int width;
+        int height;
+    };
+
+    // The smallest layout with room for texelCount texels, empty for none.
+    static GSplatTextureLayout forTexelCount(const size_t texelCount);
+
+    bool isEmpty() const { return myLayerCount == 0; }
+    int getWidth() const { return isEmpty() ? 0 : WIDTH; }
+    int getHeight() const { return myHeight; }
+    int getLayerCount() const { return myLayerCount; }
+    size_t getTexelCount() const { return size_t(getWidth()) * size_t(myHeight) * size_t(myLayerCount); }
+
+    // Calls f(rect, texelOffset) for texels [texelBegin, texelEnd), as a partial first row, whole
+    // rows and a partial last row within each layer they cover. texelOffset is where the texels
+    // of rect start, counted from texelBegin.
+    template <typename F>
+    void forEachRect(const size_t texelBegin, const size_t texelEnd, F &&f) const
+    {
+        size_t texel = texelBegin;
+        while (texel < texelEnd)
+        {
+            const size_t row = texel / WIDTH;
+            Rect rect;
+            rect.x = static_cast<int>(texel % WIDTH);
+            rect.y = static_cast<int>(row % size_t(myHeight));
+            rect.layer = static_cast<int>(row / size_t(myHeight));
+            rect.width = static_cast<int>(std::min(size_t(WIDTH - rect.x), texelEnd - texel));
+            rect.height = 1;
+            if (rect.x == 0 && texelEnd - texel >= size_t(WIDTH))
+            {
+                rect.width = WIDTH;
+                rect.height = static_cast<int>(std::min((texelEnd - texel) / WIDTH, size_t(myHeight - rect.y)));
+            }
+            f(rect, texel - texelBegin);
+            texel += size_t(rect.width) * size_t(rect.height);
+        }
+    }
+
+    bool operator==(const GSplatTextureLayout &other) const { return myHeight == other.myHeight && myLayerCount == other.myLayerCount; }
+    bool operator!=(const GSplatTextureLayout &other) const { return !(*this == other); }
+
+private:
+    int myHeight = 0;
+    int myLayerCount = 0;
+};
+
+
+#endif // __GSPLAT_TEXTURE_LAYOUT__
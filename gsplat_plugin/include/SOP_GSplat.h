@@ -15,6 +15,8 @@
 
 #include <SOP/SOP_Node.h>
 
+class GEO_PrimGsplat;
+
 
 class SOP_Gsplat : public SOP_Node
 {
@@ -27,6 +29,13 @@ protected:
     ~SOP_Gsplat() override;
 
     OP_ERROR cookMySop(OP_Context &context) override;
+
+private:
+    // Builds a LOD hierarchy over the points of gdp and appends its nodes as points
+    void appendLodHierarchy();
+    // Writes the transform of every point of instanceGdp into the gsplat_instance_transforms
+    // array of prim, see GSplatRenderer::rebuildInstances
+    void writeInstanceTransforms(const GU_Detail *instanceGdp, GEO_PrimGsplat *prim);
 };
 
 
@@ -0,0 +1,35 @@
+/***************************************************************************************/
+/*  Filename: SOP_GSplatFile.h                                                         */
+/*  Description: Surface Operator to read GSplat primitives from .ply and .splat files */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+
+#ifndef __SOP_GSPLAT_FILE__
+#define __SOP_GSPLAT_FILE__
+
+
+#include <SOP/SOP_Node.h>
+
+
+// Reads a 3DGS .ply or .splat file straight into the point attributes GR_PrimGsplat reads
+// (P, Cd, opacity, scale, orient and sh1..sh15), and builds the GSplat primitive over them.
+class SOP_GsplatFile : public SOP_Node
+{
+public:
+    static OP_Node *myConstructor(OP_Network*, const char *, OP_Operator *);
+    static PRM_Template myTemplateList[];
+
+protected:
+    SOP_GsplatFile(OP_Network *net, const char *name, OP_Operator *op);
+    ~SOP_GsplatFile() override;
+
+    OP_ERROR cookMySop(OP_Context &context) override;
+};
+
+
+#endif // __SOP_GSPLAT_FILE__
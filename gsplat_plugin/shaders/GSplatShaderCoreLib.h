@@ -85,7 +85,12 @@ const char* const GSplatCoreLib = R"glsl(
         float radius = length(vec2((diag1 - diag2) / 2.0, offDiag));
         float lambda1 = mid + radius;
         float lambda2 = max(mid - radius, 0.1);
-        vec2 diagVec = normalize(vec2(offDiag, lambda1 - diag1));
+        // Both are the eigenvector of lambda1, the one without a cancellation is used: lambda1 - diag1
+        // is rounding noise when the off diagonal is about zero and diag1 the larger. Zero length
+        // only when isotropic, any direction will do then.
+        vec2 diagVec = diag1 >= diag2 ? vec2(lambda1 - diag2, offDiag) : vec2(offDiag, lambda1 - diag1);
+        float diagLength = length(diagVec);
+        diagVec = diagLength > 0.0 ? diagVec / diagLength : vec2(1.0, 0.0);
         diagVec.y = -diagVec.y;
         float maxSize = 4096.0;
         v1 = min(sqrt(2.0 * lambda1), maxSize) * diagVec;
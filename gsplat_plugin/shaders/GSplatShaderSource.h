@@ -3,6 +3,8 @@
 
 
 #include "GSplatShaderCoreLib.h"
+#include "GSplatTextureLayout.h"
+#include "GSplatPageCache.h"
 #include <string>
 
 
@@ -114,25 +116,64 @@ const std::string GSplatWireFragmentShader = getFullShaderSrc("330", {_GSplatWir
 // Main Shader
 //
 
+// The row width is the same for every texture, see GSplatTextureLayout, and so is the page size, see GSplatPageCache
+const std::string GSplatAtlasLayoutDefines = "#define GSPLAT_TEXTURE_WIDTH " + std::to_string(GSplatTextureLayout::WIDTH) + "\n"
+    + "#define GSPLAT_PAGE_SIZE " + std::to_string(GSplatPageCache::PAGE_SIZE) + "\n";
+
 const char* const _GSplatMainVertexShader = R"glsl(
     
     uniform vec3 WorldSpaceCameraPos;
     uniform int GSplatCount;
-    uniform int GSplatVertexCount;
-    uniform int GSplatZOrderTexDim;
-    uniform isampler2D GSplatZOrderIntegerTexSampler;
-    uniform int GSplatPosColorAlphaScaleOrientTexDim;
-    uniform sampler2D GSplatPosColorAlphaScaleOrientTexSampler;
-
-    uniform int GSplatShDeg1And2TexDim;
-    uniform sampler2D GSplatShDeg1And2TexSampler;
-    uniform int GSplatShDeg3TexDim;
-    uniform sampler2D GSplatShDeg3TexSampler;
+    uniform int GSplatZOrderTexHeight;
+    uniform isampler2DArray GSplatZOrderIntegerTexSampler;
+    uniform int GSplatPosColorAlphaCovarianceTexHeight;
+    uniform sampler2DArray GSplatPosColorAlphaCovarianceTexSampler;
+
+    // Compact encoding, one RGBA32UI texel per splat, see GSplatQuantizer
+    uniform int GSplatCompactEncoding;
+    uniform int GSplatChunkSize;
+    uniform int GSplatCompactTexHeight;
+    uniform usampler2DArray GSplatCompactTexSampler;
+    uniform int GSplatChunkBoundsTexHeight;
+    uniform sampler2DArray GSplatChunkBoundsTexSampler;
+
+    // SH codebook, the SH textures then hold codebook entries indexed per splat, see GSplatShCodebook
+    uniform int GSplatShCodebook;
+    uniform int GSplatShIndexTexHeight;
+    uniform isampler2DArray GSplatShIndexTexSampler;
+
+    uniform int GSplatShDeg1TexHeight;
+    uniform sampler2DArray GSplatShDeg1TexSampler;
+    uniform int GSplatShDeg2TexHeight;
+    uniform sampler2DArray GSplatShDeg2TexSampler;
+    uniform int GSplatShDeg3TexHeight;
+    uniform sampler2DArray GSplatShDeg3TexSampler;
 
     uniform int GSplatShOrder;
     uniform vec3 GSplatOrigin;
 
-
+    // SH baked on the CPU, what they add to the colour of every sorted splat, see GSplatShBaker
+    uniform int GSplatShBaked;
+    uniform int GSplatShBakedTexHeight;
+    uniform sampler2DArray GSplatShBakedTexSampler;
+
+    // Out of core atlas, the slot of every page or -1 when it is not resident, see GSplatPageCache
+    uniform int GSplatPaging;
+    uniform int GSplatPageTableTexHeight;
+    uniform isampler2DArray GSplatPageTableTexSampler;
+
+    // Instances, sorted indices from GSplatInstanceSlotBegin on are slots of their copies. Every
+    // chunk of the copies has the atlas slot it was copied from and its instance, every instance
+    // the rows of its transform, see GSplatRenderer::rebuildInstances
+    uniform int GSplatInstancing;
+    uniform int GSplatInstanceSlotBegin;
+    uniform int GSplatInstanceChunkTexHeight;
+    uniform isampler2DArray GSplatInstanceChunkTexSampler;
+    uniform int GSplatInstanceTransformTexHeight;
+    uniform sampler2DArray GSplatInstanceTransformTexSampler;
+
+    #ifdef GSPLAT_QUAD_VERTICES
+    // Once per vertex of the two triangles of the quad, each of the six repeats the per splat work
     out parms
     {
         vec4  pos;
@@ -140,6 +181,8 @@ const char* const _GSplatMainVertexShader = R"glsl(
         float opacity;
     } vsOut;
 
+    uniform vec2    glH_DepthRange;
+
     #if defined(VENDOR_NVIDIA) && DRIVER_MAJOR >= 343
     out gl_PerVertex
     {
@@ -149,22 +192,75 @@ const char* const _GSplatMainVertexShader = R"glsl(
     #endif // CLIP_DISTANCE
     };
     #endif // defined(VENDOR_NVIDIA)...
+    #else
+    // Once per splat, the geometry shader expands the quad
+    out splat
+    {
+        vec4  clipPos;
+        vec4  axes;     // both quad axes, in clip space units per w
+        vec3  color;
+        float opacity;  // 0 drops the splat
+    } vsOut;
+    #endif // GSPLAT_QUAD_VERTICES
 
     uniform mat4    glH_ObjViewMatrix;
     uniform mat4    glH_ObjectMatrix;
     uniform mat4    glH_InvObjectMatrix;
     uniform mat4    glH_ViewMatrix;
     uniform mat4    glH_ProjectMatrix;
-    uniform vec2    glH_DepthRange;
     uniform vec2    glH_ScreenSize;
 
-    ivec2 computeTextureCoordinates(int index, int textureDimension, int pixelStride) {
-        int linearIndex = index * pixelStride;
-        int row = linearIndex / textureDimension;
-        int column = linearIndex % textureDimension;
-        return ivec2(column, row);
+    // First texel of element index, pixelStride texels per element in a texture array with
+    // layers of layerHeight rows, see GSplatTextureLayout. The texel index itself can exceed
+    // the int range, so it is never computed.
+    ivec3 computeTextureCoordinates(int index, int layerHeight, int pixelStride) {
+        int elementsPerRow = GSPLAT_TEXTURE_WIDTH / pixelStride;
+        int row = index / elementsPerRow;
+        int column = (index - row * elementsPerRow) * pixelStride;
+        return ivec3(column, row % layerHeight, row / layerHeight);
+    }
+
+    vec3 DecodeCompactPosition(uvec4 encoded, int chunkIdx)
+    {
+        ivec3 iuv = computeTextureCoordinates(chunkIdx, GSplatChunkBoundsTexHeight, 4);
+        vec3 positionMin = texelFetch(GSplatChunkBoundsTexSampler, iuv, 0).xyz;
+        vec3 positionExtent = texelFetch(GSplatChunkBoundsTexSampler, iuv + ivec3(1, 0, 0), 0).xyz;
+        uvec3 q = uvec3(encoded.x & 0xFFFFu, encoded.x >> 16, encoded.y & 0xFFFFu);
+        return positionMin + vec3(q) / 65535.0 * positionExtent;
+    }
+
+    void DecodeCompactAttributes(uvec4 encoded, int chunkIdx, out vec4 colorAlpha, out vec3 scale, out vec4 orient)
+    {
+        colorAlpha = vec4(
+            float((encoded.y >> 16) & 0xFFu),
+            float(encoded.y >> 24),
+            float(encoded.z & 0xFFu),
+            float((encoded.z >> 8) & 0xFFu)) / 255.0;
+
+        ivec3 iuv = computeTextureCoordinates(chunkIdx, GSplatChunkBoundsTexHeight, 4);
+        vec3 logScaleMin = texelFetch(GSplatChunkBoundsTexSampler, iuv + ivec3(2, 0, 0), 0).xyz;
+        vec3 logScaleExtent = texelFetch(GSplatChunkBoundsTexSampler, iuv + ivec3(3, 0, 0), 0).xyz;
+        uvec3 qs = uvec3((encoded.z >> 16) & 0x7Fu, (encoded.z >> 23) & 0x7Fu, encoded.w & 0x7Fu);
+        scale = exp(logScaleMin + vec3(qs) / 127.0 * logScaleExtent);
+
+        // Smallest three: the largest component is positive and rebuilt from the other three
+        int largest = int(encoded.z >> 30);
+        uvec3 qo = uvec3((encoded.w >> 7) & 0xFFu, (encoded.w >> 15) & 0xFFu, encoded.w >> 23);
+        vec3 small = (vec3(qo) / 255.0 * 2.0 - 1.0) * 0.70710678;
+        float rebuilt = sqrt(max(0.0, 1.0 - dot(small, small)));
+        if (largest == 0)
+            orient = vec4(rebuilt, small.x, small.y, small.z);
+        else
+        if (largest == 1)
+            orient = vec4(small.x, rebuilt, small.y, small.z);
+        else
+        if (largest == 2)
+            orient = vec4(small.x, small.y, rebuilt, small.z);
+        else
+            orient = vec4(small.x, small.y, small.z, rebuilt);
     }
 
+    #ifdef GSPLAT_QUAD_VERTICES
     vec2 CalculateQuadPos(int GSplatVtxIdx)
     {
         vec2 quadPos = vec2(0,0);
@@ -186,20 +282,72 @@ const char* const _GSplatMainVertexShader = R"glsl(
         quadPos *= 2;
         return quadPos;
     }
+    #endif // GSPLAT_QUAD_VERTICES
+
+    // Fully transparent, dropped by the geometry shader, or a degenerate quad without one
+    void DropSplat()
+    {
+        vsOut.opacity = 0.0;
+    #ifdef GSPLAT_QUAD_VERTICES
+        gl_Position = vec4(0,0,0,0);
+    #endif // GSPLAT_QUAD_VERTICES
+    }
 
     void main()
     {
         int GsplatIdx = gl_InstanceID;
-        int GSplatVtxIdx = gl_VertexID;
 
-        ivec2 iuv;
+        ivec3 iuv;
         
-        iuv = computeTextureCoordinates(GsplatIdx, GSplatZOrderTexDim, 1);
+        iuv = computeTextureCoordinates(GsplatIdx, GSplatZOrderTexHeight, 1);
         GsplatIdx = texelFetch(GSplatZOrderIntegerTexSampler, iuv, 0).r;
 
-        iuv = computeTextureCoordinates(GsplatIdx, GSplatPosColorAlphaScaleOrientTexDim, 4);
-        vec3 P = texelFetch(GSplatPosColorAlphaScaleOrientTexSampler, iuv, 0).rgb;
+        bool isInstance = GSplatInstancing != 0 && GsplatIdx >= GSplatInstanceSlotBegin;
+        vec4 instanceRows[3];
+        if (isInstance)
+        {
+            int copyIdx = GsplatIdx - GSplatInstanceSlotBegin;
+            iuv = computeTextureCoordinates(copyIdx / GSplatChunkSize, GSplatInstanceChunkTexHeight, 1);
+            ivec2 copiedChunk = texelFetch(GSplatInstanceChunkTexSampler, iuv, 0).rg;
+            GsplatIdx = copiedChunk.x + copyIdx % GSplatChunkSize;
+            iuv = computeTextureCoordinates(copiedChunk.y, GSplatInstanceTransformTexHeight, 4);
+            instanceRows[0] = texelFetch(GSplatInstanceTransformTexSampler, iuv, 0);
+            instanceRows[1] = texelFetch(GSplatInstanceTransformTexSampler, iuv + ivec3(1, 0, 0), 0);
+            instanceRows[2] = texelFetch(GSplatInstanceTransformTexSampler, iuv + ivec3(2, 0, 0), 0);
+        }
+
+        if (GSplatPaging != 0)
+        {
+            iuv = computeTextureCoordinates(GsplatIdx / GSPLAT_PAGE_SIZE, GSplatPageTableTexHeight, 1);
+            int pageSlot = texelFetch(GSplatPageTableTexSampler, iuv, 0).r;
+            if (pageSlot < 0)
+            {
+                // Evicted since the order was sorted, dropped like the splats behind the camera
+                DropSplat();
+                return;
+            }
+            GsplatIdx = pageSlot * GSPLAT_PAGE_SIZE + GsplatIdx % GSPLAT_PAGE_SIZE;
+        }
+
+        uvec4 compactSplat = uvec4(0u);
+        int chunkIdx = 0;
+        vec3 P;
+        if (GSplatCompactEncoding != 0)
+        {
+            chunkIdx = GsplatIdx / GSplatChunkSize;
+            compactSplat = texelFetch(GSplatCompactTexSampler, computeTextureCoordinates(GsplatIdx, GSplatCompactTexHeight, 1), 0);
+            P = DecodeCompactPosition(compactSplat, chunkIdx);
+        }
+        else
+        {
+            iuv = computeTextureCoordinates(GsplatIdx, GSplatPosColorAlphaCovarianceTexHeight, 4);
+            P = texelFetch(GSplatPosColorAlphaCovarianceTexSampler, iuv, 0).rgb;
+        }
         P += GSplatOrigin;
+        if (isInstance)
+        {
+            P = vec3(dot(instanceRows[0], vec4(P, 1.0)), dot(instanceRows[1], vec4(P, 1.0)), dot(instanceRows[2], vec4(P, 1.0)));
+        }
 
         mat4 flipYMatrix = mat4(1,0,0,0,0,-1,0,0,0,0,1,0,0,0,0,1);
         
@@ -208,87 +356,204 @@ const char* const _GSplatMainVertexShader = R"glsl(
 
         if (centerClipPos.w <= 0)
         {
-            // set behind camera to fully transparent so is discarded in fragment shader
-            gl_Position = vec4(0,0,0,0);
-            vsOut.opacity = 0.0;
+            // set behind camera to fully transparent so is dropped
+            DropSplat();
         }
         else
         {
-            // Unpack color, alpha, scale, orient 
-            vec4 color_and_alpha = texelFetch(GSplatPosColorAlphaScaleOrientTexSampler, iuv + ivec2(1, 0), 0).rgba;
+            // Unpack color, alpha and the 3D covariance, built from scale and orient with the compact encoding
+            vec4 color_and_alpha;
+            mat3 sigma;
+            if (GSplatCompactEncoding != 0)
+            {
+                vec3 scale;
+                vec4 orient;
+                DecodeCompactAttributes(compactSplat, chunkIdx, color_and_alpha, scale, orient);
+                vec3 sigma0, sigma1;
+                CalcCovariance3D(CalcMatrixFromRotationScale(orient.wxyz, scale), sigma0, sigma1, sigma);
+            }
+            else
+            {
+                color_and_alpha = texelFetch(GSplatPosColorAlphaCovarianceTexSampler, iuv + ivec3(1, 0, 0), 0).rgba;
+                vec4 sigma0 = texelFetch(GSplatPosColorAlphaCovarianceTexSampler, iuv + ivec3(2, 0, 0), 0);
+                vec2 sigma1 = texelFetch(GSplatPosColorAlphaCovarianceTexSampler, iuv + ivec3(3, 0, 0), 0).rg;
+                sigma = mat3(
+                    sigma0.x, sigma0.y, sigma0.z,
+                    sigma0.y, sigma0.w, sigma1.x,
+                    sigma0.z, sigma1.x, sigma1.y
+                );
+            }
             vec3 color = color_and_alpha.rgb;
             float alpha = color_and_alpha.a;
-            vec3 scale = texelFetch(GSplatPosColorAlphaScaleOrientTexSampler, iuv + ivec2(2, 0), 0).rgb;
-            vec4 orient = texelFetch(GSplatPosColorAlphaScaleOrientTexSampler, iuv + ivec2(3, 0), 0).xyzw;
 
             vsOut.color = color;
             vsOut.opacity = alpha;
 
-            vec2 quadPos = CalculateQuadPos(GSplatVtxIdx);
-            vsOut.pos = vec4(quadPos, 0, 1);
-            
-            mat3 splatRotScaleMat = CalcMatrixFromRotationScale(orient.wxyz, scale);
-            splatRotScaleMat = splatRotScaleMat * transpose(mat3(glH_ObjectMatrix));
+            // The covariance of M * X * transpose(mat3(glH_ObjectMatrix)), M the rotation scale matrix of the splat
+            if (isInstance)
+            {
+                // Transposed linear part of the instance transform, applied before the object's
+                mat3 instanceMat = mat3(instanceRows[0].xyz, instanceRows[1].xyz, instanceRows[2].xyz);
+                sigma = transpose(instanceMat) * sigma * instanceMat;
+            }
+            sigma = mat3(glH_ObjectMatrix) * sigma * transpose(mat3(glH_ObjectMatrix));
 
-            vec3 cov3d0, cov3d1;
-            mat3 sigma;
-            CalcCovariance3D(splatRotScaleMat, cov3d0, cov3d1, sigma);
-            float splatScale = 1.0;
-            float splatScale2 = splatScale * splatScale;
-            cov3d0 *= splatScale2;
-            cov3d1 *= splatScale2;
+            vec3 cov3d0 = vec3(sigma[0][0], sigma[0][1], sigma[0][2]);
+            vec3 cov3d1 = vec3(sigma[1][1], sigma[1][2], sigma[2][2]);
             vec3 cov2d = CalcCovariance2D(P, cov3d0, cov3d1, glH_ViewMatrix, glH_ProjectMatrix, glH_ScreenSize, sigma);
             vec2 view_axis1, view_axis2;
             DecomposeCovariance(cov2d, view_axis1, view_axis2);
+            vec4 axes = vec4(view_axis1, view_axis2) * 2 / glH_ScreenSize.xyxy;
+
+    #ifdef GSPLAT_QUAD_VERTICES
+            vec2 quadPos = CalculateQuadPos(gl_VertexID);
+            vsOut.pos = vec4(quadPos, 0, 1);
+            vec4 out_vertex = centerClipPos;
+            out_vertex.xy += (quadPos.x * axes.xy + quadPos.y * axes.zw) * centerClipPos.w;
+            out_vertex.y = -out_vertex.y;
+            gl_Position = out_vertex;
+        #ifdef  CLIP_DISTANCE
+            gl_ClipDistance[0] = -vsOut.pos.z - glH_DepthRange.x;
+            gl_ClipDistance[1] = glH_DepthRange.y +vsOut.pos.z;
+        #endif // CLIP_DISTANCE
+    #else
+            vsOut.clipPos = centerClipPos;
+            vsOut.axes = axes;
+    #endif // GSPLAT_QUAD_VERTICES
 
             if (GSplatShOrder > 0)
             {
-                vec3 sh1, sh2, sh3, sh4, sh5, sh6, sh7, sh8, sh9, sh10, sh11, sh12, sh13, sh14, sh15;
-
-                // Unpack spherical harmonics
-                iuv = computeTextureCoordinates(GsplatIdx, GSplatShDeg1And2TexDim, 8);
-                sh1 = texelFetch(GSplatShDeg1And2TexSampler, iuv, 0).rgb;
-                sh2 = texelFetch(GSplatShDeg1And2TexSampler, iuv + ivec2(1,0), 0).rgb;
-                sh3 = texelFetch(GSplatShDeg1And2TexSampler, iuv + ivec2(2,0), 0).rgb;
-                sh4 = texelFetch(GSplatShDeg1And2TexSampler, iuv + ivec2(3,0), 0).rgb;
-                sh5 = texelFetch(GSplatShDeg1And2TexSampler, iuv + ivec2(4,0), 0).rgb;
-                sh6 = texelFetch(GSplatShDeg1And2TexSampler, iuv + ivec2(5,0), 0).rgb;
-                sh7 = texelFetch(GSplatShDeg1And2TexSampler, iuv + ivec2(6,0), 0).rgb;
-                sh8 = texelFetch(GSplatShDeg1And2TexSampler, iuv + ivec2(7,0), 0).rgb;
-                
+                vec3 sh1, sh2, sh3;
+                vec3 sh4 = vec3(0.0), sh5 = vec3(0.0), sh6 = vec3(0.0), sh7 = vec3(0.0), sh8 = vec3(0.0);
+                vec3 sh9 = vec3(0.0), sh10 = vec3(0.0), sh11 = vec3(0.0), sh12 = vec3(0.0), sh13 = vec3(0.0), sh14 = vec3(0.0), sh15 = vec3(0.0);
+
+                int shIdx = GsplatIdx;
+                if (GSplatShCodebook != 0)
+                {
+                    shIdx = texelFetch(GSplatShIndexTexSampler, computeTextureCoordinates(GsplatIdx, GSplatShIndexTexHeight, 1), 0).r;
+                }
+
+                // Unpack spherical harmonics, one texture per degree and only up to the order in use
+                iuv = computeTextureCoordinates(shIdx, GSplatShDeg1TexHeight, 4);
+                sh1 = texelFetch(GSplatShDeg1TexSampler, iuv, 0).rgb;
+                sh2 = texelFetch(GSplatShDeg1TexSampler, iuv + ivec3(1, 0, 0), 0).rgb;
+                sh3 = texelFetch(GSplatShDeg1TexSampler, iuv + ivec3(2, 0, 0), 0).rgb;
+
+                if (GSplatShOrder > 1)
+                {
+                    // Five rgb coefficients spread over four rgba texels
+                    iuv = computeTextureCoordinates(shIdx, GSplatShDeg2TexHeight, 4);
+                    vec4 deg2Texel0 = texelFetch(GSplatShDeg2TexSampler, iuv, 0);
+                    vec4 deg2Texel1 = texelFetch(GSplatShDeg2TexSampler, iuv + ivec3(1, 0, 0), 0);
+                    vec4 deg2Texel2 = texelFetch(GSplatShDeg2TexSampler, iuv + ivec3(2, 0, 0), 0);
+                    vec4 deg2Texel3 = texelFetch(GSplatShDeg2TexSampler, iuv + ivec3(3, 0, 0), 0);
+                    sh4 = deg2Texel0.rgb;
+                    sh5 = vec3(deg2Texel0.a, deg2Texel1.rg);
+                    sh6 = vec3(deg2Texel1.ba, deg2Texel2.r);
+                    sh7 = deg2Texel2.gba;
+                    sh8 = deg2Texel3.rgb;
+                }
+
                 if (GSplatShOrder > 2)
                 {
-                    iuv = computeTextureCoordinates(GsplatIdx, GSplatShDeg3TexDim, 8);
+                    iuv = computeTextureCoordinates(shIdx, GSplatShDeg3TexHeight, 8);
                     sh9  = texelFetch(GSplatShDeg3TexSampler, iuv, 0).rgb;
-                    sh10 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec2(1,0), 0).rgb;
-                    sh11 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec2(2,0), 0).rgb;
-                    sh12 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec2(3,0), 0).rgb;
-                    sh13 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec2(4,0), 0).rgb;
-                    sh14 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec2(5,0), 0).rgb;
-                    sh15 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec2(6,0), 0).rgb;
+                    sh10 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec3(1, 0, 0), 0).rgb;
+                    sh11 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec3(2, 0, 0), 0).rgb;
+                    sh12 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec3(3, 0, 0), 0).rgb;
+                    sh13 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec3(4, 0, 0), 0).rgb;
+                    sh14 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec3(5, 0, 0), 0).rgb;
+                    sh15 = texelFetch(GSplatShDeg3TexSampler, iuv + ivec3(6, 0, 0), 0).rgb;
                 }
                 
                 vec3 worldCamToPoint = vec3(P.x, P.y, P.z) - vec3(WorldSpaceCameraPos.x, WorldSpaceCameraPos.y, WorldSpaceCameraPos.z); 
                 vec3 objCamToPoint = mat3(glH_InvObjectMatrix) * worldCamToPoint;
+                if (isInstance)
+                {
+                    // SH are evaluated in the frame of the splats as they were packed
+                    objCamToPoint = inverse(transpose(mat3(instanceRows[0].xyz, instanceRows[1].xyz, instanceRows[2].xyz))) * objCamToPoint;
+                }
                 vec3 shDir = normalize(objCamToPoint);
                 vsOut.color = ShadeSH(vsOut.color, sh1, sh2, sh3, sh4, sh5, sh6, sh7, sh8, sh9, sh10, sh11, sh12, sh13, sh14, sh15, shDir, GSplatShOrder, false);
             }
+            else if (GSplatShBaked != 0)
+            {
+                // Indexed like the sorted indices, clamped as ShadeSH does
+                vec3 shBaked = texelFetch(GSplatShBakedTexSampler, computeTextureCoordinates(gl_InstanceID, GSplatShBakedTexHeight, 1), 0).rgb;
+                vsOut.color = max(vsOut.color + shBaked, vec3(0.0));
+            }
+        }
+    }
+
+)glsl";
+const std::string GSplatMainVertexShader = getFullShaderSrc("330", {GSplatAtlasLayoutDefines.c_str(), GSplatCoreLib, GSplatSphericalHarmonicsLib, _GSplatMainVertexShader});
+// The same without a geometry shader, drawn as six vertices per splat, see GSplatRenderer::setQuadVertices
+const std::string GSplatMainQuadVertexShader = getFullShaderSrc("330", {"#define GSPLAT_QUAD_VERTICES\n", GSplatAtlasLayoutDefines.c_str(), GSplatCoreLib, GSplatSphericalHarmonicsLib, _GSplatMainVertexShader});
+
+const char* const _GSplatMainGeometryShader = R"glsl(
+
+    layout(points) in;
+    layout(triangle_strip, max_vertices = 4) out;
+
+    uniform vec2    glH_DepthRange;
+
+    in splat
+    {
+        vec4  clipPos;
+        vec4  axes;
+        vec3  color;
+        float opacity;
+    } gsIn[];
 
-            vec2 deltaScreenPos = (quadPos.x * view_axis1 + quadPos.y * view_axis2) * 2 / glH_ScreenSize;
+    out parms
+    {
+        vec4  pos;
+        vec3  color;
+        float opacity;
+    } gsOut;
+
+    #if defined(VENDOR_NVIDIA) && DRIVER_MAJOR >= 343
+    out gl_PerVertex
+    {
+        vec4 gl_Position;
+    #ifdef CLIP_DISTANCE
+        float gl_ClipDistance[2];
+    #endif // CLIP_DISTANCE
+    };
+    #endif // defined(VENDOR_NVIDIA)...
+
+    void main()
+    {
+        if (gsIn[0].opacity <= 0.0)
+        {
+            return;
+        }
+
+        vec4 centerClipPos = gsIn[0].clipPos;
+        for (int i = 0; i < 4; ++i)
+        {
+            // Corners of the quad in strip order, 2 standard deviations out
+            vec2 quadPos = vec2(i & 1, i >> 1) * 4 - 2;
+            vec2 deltaScreenPos = quadPos.x * gsIn[0].axes.xy + quadPos.y * gsIn[0].axes.zw;
             vec4 out_vertex = centerClipPos;
             out_vertex.xy += deltaScreenPos * centerClipPos.w;
-            
             out_vertex.y = -out_vertex.y;
+
             gl_Position = out_vertex;
+            gsOut.pos = vec4(quadPos, 0, 1);
+            gsOut.color = gsIn[0].color;
+            gsOut.opacity = gsIn[0].opacity;
     #ifdef  CLIP_DISTANCE
-            gl_ClipDistance[0] = -vsOut.pos.z - glH_DepthRange.x;
-            gl_ClipDistance[1] = glH_DepthRange.y +vsOut.pos.z;
+            gl_ClipDistance[0] = -gsOut.pos.z - glH_DepthRange.x;
+            gl_ClipDistance[1] = glH_DepthRange.y +gsOut.pos.z;
     #endif // CLIP_DISTANCE
+            EmitVertex();
         }
+        EndPrimitive();
     }
 
 )glsl";
-const std::string GSplatMainVertexShader = getFullShaderSrc("330", {GSplatCoreLib, GSplatSphericalHarmonicsLib, _GSplatMainVertexShader});
+const std::string GSplatMainGeometryShader = getFullShaderSrc("330", {_GSplatMainGeometryShader});
 
 const char* const _GSplatMainFragmentShader = R"glsl(
     
@@ -0,0 +1,81 @@
+/***************************************************************************************/
+/*  Filename: GSplatTest.h                                                             */
+/*  Description: Minimal unit test harness for the GSplat core                         */
+/*                                                                                     */
+/*  Copyright (C) 2024 Ruben Diaz                                                      */
+/*                                                                                     */
+/*  License: AGPL-3.0-or-later                                                         */
+/*           https://github.com/rubendhz/houdini-gsplat-renderer/blob/develop/LICENSE  */
+/***************************************************************************************/
+
+#ifndef __GSPLAT_TEST__
+#define __GSPLAT_TEST__
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+// Tests register themselves at static initialisation time under a suite name,
+// gsplat_core_tests runs the suite named on its command line (all of them without one).
+namespace GSplatTest
+{
+    typedef void (*TestFunction)();
+
+    struct TestCase
+    {
+        const char *suite;
+        const char *name;
+        TestFunction function;
+    };
+
+    inline std::vector<TestCase>& getTestCases()
+    {
+        static std::vector<TestCase> testCases;
+        return testCases;
+    }
+
+    inline int& getFailureCount()
+    {
+        static int failureCount = 0;
+        return failureCount;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char *suite, const char *name, TestFunction function)
+        {
+            getTestCases().push_back({ suite, name, function });
+        }
+    };
+
+    inline void reportFailure(const char *file, const int line, const std::string &message)
+    {
+        std::fprintf(stderr, "%s:%d: FAILED %s\n", file, line, message.c_str());
+        ++getFailureCount();
+    }
+}
+
+#define GSPLAT_TEST(suite, name) \
+    static void gsplatTest_##suite##_##name(); \
+    static GSplatTest::Registrar gsplatTestRegistrar_##suite##_##name(#suite, #name, &gsplatTest_##suite##_##name); \
+    static void gsplatTest_##suite##_##name()
+
+#define GSPLAT_CHECK(condition) \
+    do { \
+        if (!(condition)) \
+            GSplatTest::reportFailure(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define GSPLAT_CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        const double gsplatActual = double(actual); \
+        const double gsplatExpected = double(expected); \
+        if (!(std::fabs(gsplatActual - gsplatExpected) <= double(tolerance))) \
+            GSplatTest::reportFailure(__FILE__, __LINE__, std::string(#actual " == " #expected) + \
+                " (" + std::to_string(gsplatActual) + " vs " + std::to_string(gsplatExpected) + ")"); \
+    } while (0)
+
+
+#endif // __GSPLAT_TEST__